@@ -0,0 +1,605 @@
+/**
+ * @file affichage.c
+ * @brief Affichage et clavier du jeu du labyrinthe, sur le terminal
+ *
+ * Ce fichier contient tout ce que le menu (main.c) fait avec le terminal : composer les images dans un tampon,
+ * ne réécrire que les lignes qui changent, passer le clavier en mode brut et décoder les touches.
+ * La partie n'est connue que par le moteur (labyrinthe.h) : ce qui est affiché est lu avec ses fonctions
+ * de lecture, jamais dans ses structures.
+ *
+ * Les fonctions principales incluent :
+ * - effacerEcran / ecranAfficher : Efface le terminal, affiche une image en ne réécrivant que les lignes modifiées.
+ * - clavierActiver / lireTouches : Passe le clavier en mode brut, attend et décode les touches par lots.
+ * - afficherArbre : Affiche tout le labyrinthe, avec la position du joueur, pour le débogage.
+ * - afficherVueLabyrinthe : Affiche le voisinage du joueur.
+ * - afficherReglesDuJeu : Affiche les règles du jeu et les différents événements.
+ *
+ * @note Utilisation du compilateur GCC.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#ifdef _WIN32
+#include <conio.h>
+#include <windows.h>
+#ifndef ENABLE_VIRTUAL_TERMINAL_PROCESSING
+#define ENABLE_VIRTUAL_TERMINAL_PROCESSING 0x0004 // Absent des anciennes versions de MinGW
+#endif
+#else
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+#include "affichage.h"
+#include "labyrinthe.h"
+
+/**
+ * Activation des séquences d'échappement ANSI dans la console.
+ * Sous Windows elles doivent être activées explicitement, les autres terminaux les comprennent déjà.
+ */
+static void activerSequencesAnsi()
+{
+#ifdef _WIN32
+    static bool activees = false;
+    if (!activees)
+    {
+        HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+        DWORD mode;
+        if (GetConsoleMode(console, &mode))
+        {
+            SetConsoleMode(console, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+        }
+        activees = true;
+    }
+#endif
+}
+
+/**
+ * Hauteur du terminal.
+ * @return le nombre de lignes visibles, 0 si elle est inconnue (sortie redirigée par exemple).
+ */
+static int hauteurTerminal()
+{
+#ifdef _WIN32
+    CONSOLE_SCREEN_BUFFER_INFO infos;
+    if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &infos))
+    {
+        return infos.srWindow.Bottom - infos.srWindow.Top + 1;
+    }
+#else
+    struct winsize taille;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &taille) == 0)
+    {
+        return taille.ws_row;
+    }
+#endif
+    return 0;
+}
+
+/**
+ * Effacement du terminal et retour du curseur en haut à gauche, sans lancer de processus.
+ */
+void effacerEcran()
+{
+    activerSequencesAnsi();
+    fputs("\033[2J\033[H", stdout);
+    fflush(stdout);
+}
+
+/**
+ * Affichage d'une image en ne réécrivant que les lignes qui diffèrent de l'image précédente.
+ * Chaque ligne modifiée est réécrite à sa place et les lignes restantes de l'image précédente sont effacées,
+ * le tout en un seul appel à fwrite. Une image plus haute que le terminal est réécrite entièrement.
+ * Comme avec tamponEnvoyer, l'image est vidée et sa taille (octets réellement écrits) et son temps sont retenus.
+ * @param ecran L'état du terminal.
+ * @param image L'image à afficher.
+ * @param flux Le flux du terminal.
+ */
+void ecranAfficher(Ecran *ecran, Tampon *image, FILE *flux)
+{
+    Tampon *sequences = &ecran->sequences;
+    sequences->taille = 0;
+    activerSequencesAnsi();
+
+    int nbLignes = 0;
+    for (size_t i = 0; i < image->taille; i++)
+    {
+        nbLignes += image->donnees[i] == '\n';
+    }
+    int hauteur = hauteurTerminal();
+    bool tropHaute = hauteur > 0 && nbLignes >= hauteur; // Le terminal va défiler, les positions ne sont plus fiables
+
+    if (!ecran->pret || tropHaute)
+    {
+        tamponAjouter(sequences, "\033[2J\033[H");
+        ecran->affichee.taille = 0;
+    }
+
+    int lignesModifiees = 0;
+    if (tropHaute)
+    {
+        // On réécrit tout, et la prochaine image repartira d'un terminal effacé
+        if (image->taille > 0)
+        {
+            tamponAjouter(sequences, "%.*s", (int)image->taille, image->donnees);
+        }
+        lignesModifiees = nbLignes;
+        ecran->pret = false;
+    }
+    else
+    {
+        const char *nouvelle = image->donnees;
+        const char *finNouvelle = nouvelle + image->taille;
+        const char *ancienne = ecran->affichee.donnees;
+        const char *finAncienne = ancienne + ecran->affichee.taille;
+        int ligne = 1;
+        size_t colonne = 1;
+        while (nouvelle < finNouvelle)
+        {
+            const char *finLigne = memchr(nouvelle, '\n', finNouvelle - nouvelle);
+            size_t longueur = (finLigne ? finLigne : finNouvelle) - nouvelle;
+
+            // Ligne correspondante de l'image précédente
+            bool identique = false;
+            if (ancienne < finAncienne)
+            {
+                const char *finLigneAncienne = memchr(ancienne, '\n', finAncienne - ancienne);
+                size_t longueurAncienne = (finLigneAncienne ? finLigneAncienne : finAncienne) - ancienne;
+                identique = longueurAncienne == longueur && memcmp(ancienne, nouvelle, longueur) == 0;
+                ancienne = finLigneAncienne ? finLigneAncienne + 1 : finAncienne;
+            }
+            if (!identique)
+            {
+                tamponAjouter(sequences, "\033[%d;1H%.*s\033[K", ligne, (int)longueur, nouvelle);
+                lignesModifiees++;
+            }
+
+            if (finLigne == NULL) // Dernière ligne sans retour à la ligne : le curseur reste au bout
+            {
+                colonne = longueur + 1;
+                break;
+            }
+            nouvelle = finLigne + 1;
+            ligne++;
+        }
+        // On efface ce qui reste de l'image précédente, puis on replace le curseur à la fin de l'image
+        if (ancienne < finAncienne)
+        {
+            tamponAjouter(sequences, "\033[%d;1H\033[J", colonne == 1 ? ligne : ligne + 1);
+        }
+        tamponAjouter(sequences, "\033[%d;%zuH", ligne, colonne);
+
+        // L'image devient l'image affichée ; on récupère l'ancienne mémoire pour la prochaine image
+        Tampon precedente = ecran->affichee;
+        ecran->affichee.donnees = image->donnees;
+        ecran->affichee.taille = image->taille;
+        ecran->affichee.capacite = image->capacite;
+        image->donnees = precedente.donnees;
+        image->capacite = precedente.capacite;
+        ecran->pret = true;
+    }
+
+    fwrite(sequences->donnees, 1, sequences->taille, flux);
+    fflush(flux);
+    labyrinthe_stats_frame(sequences->taille);
+    ecran->lignesModifiees = lignesModifiees;
+    image->dernierTempsNs = image->debutNs == 0 ? 0 : labyrinthe_clock() - image->debutNs;
+    image->derniereTaille = sequences->taille;
+    image->taille = 0;
+    image->debutNs = 0;
+}
+
+/**
+ * Libération de la mémoire de l'état du terminal.
+ * @param ecran L'état du terminal.
+ */
+void ecranLiberer(Ecran *ecran)
+{
+    tamponLiberer(&ecran->affichee);
+    tamponLiberer(&ecran->sequences);
+    ecran->pret = false;
+}
+
+#ifndef _WIN32
+static struct termios terminalInitial; // Réglages du terminal à restaurer en fin de partie
+static bool terminalBrut = false;      // Vrai si le terminal est en mode brut
+#endif
+
+/**
+ * Passage du clavier en mode brut : chaque touche est reçue immédiatement, sans écho.
+ * Sous Windows, conio.h lit déjà les touches une à une ; une entrée redirigée est laissée telle quelle.
+ */
+void clavierActiver()
+{
+#ifndef _WIN32
+    if (terminalBrut || tcgetattr(STDIN_FILENO, &terminalInitial) != 0)
+    {
+        return;
+    }
+    struct termios brut = terminalInitial;
+    brut.c_lflag &= ~(ICANON | ECHO | ISIG | IEXTEN); // Ctrl+C arrive comme une touche, et quitte la partie
+    brut.c_iflag &= ~(IXON | ICRNL);
+    brut.c_cc[VMIN] = 0; // read ne bloque jamais, l'attente se fait avec poll
+    brut.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSAFLUSH, &brut);
+    terminalBrut = true;
+#endif
+}
+
+/**
+ * Retour du clavier au mode ligne, pour le menu.
+ */
+void clavierRestaurer()
+{
+#ifndef _WIN32
+    if (terminalBrut)
+    {
+        tcsetattr(STDIN_FILENO, TCSAFLUSH, &terminalInitial);
+        terminalBrut = false;
+    }
+#endif
+}
+
+#ifndef _WIN32
+/**
+ * Lecture des octets disponibles sur l'entrée, après une attente d'au plus delaiMs.
+ * @param octets Le tableau à compléter.
+ * @param nbOctets Le nombre d'octets déjà présents, mis à jour.
+ * @param capacite La taille du tableau.
+ * @param delaiMs L'attente maximale en millisecondes, -1 pour attendre indéfiniment.
+ * @return 1 si des octets ont été lus, 0 si le délai est écoulé, -1 à la fin de l'entrée.
+ */
+static int lireOctets(unsigned char *octets, int *nbOctets, int capacite, int delaiMs)
+{
+    struct pollfd entree = {STDIN_FILENO, POLLIN, 0};
+    if (poll(&entree, 1, delaiMs) <= 0)
+    {
+        return 0; // Délai écoulé ou signal
+    }
+    ssize_t lus = read(STDIN_FILENO, octets + *nbOctets, capacite - *nbOctets);
+    if (lus <= 0)
+    {
+        return -1;
+    }
+    *nbOctets += lus;
+    return 1;
+}
+#endif
+
+/**
+ * Attente puis lecture de toutes les touches disponibles.
+ * Les flèches sont décodées (séquences ANSI ESC [ A..D sous POSIX, préfixes 0 et 224 de conio.h sous Windows),
+ * Echap et Ctrl+C donnent CLAVIER_ECHAP, tout le reste CLAVIER_AUTRE. La fin de l'entrée équivaut à Echap.
+ * @param touches Le tableau à remplir.
+ * @param max Le nombre maximum de touches à lire.
+ * @param delaiMs L'attente maximale de la première touche en millisecondes, -1 pour attendre indéfiniment.
+ * @return le nombre de touches lues, 0 si le délai est écoulé.
+ */
+int lireTouches(ToucheClavier *touches, int max, int delaiMs)
+{
+    int nbTouches = 0;
+#ifdef _WIN32
+    double limite = labyrinthe_clock() + delaiMs * 1e6;
+    while (!_kbhit())
+    {
+        if (delaiMs >= 0 && labyrinthe_clock() >= limite)
+        {
+            return 0;
+        }
+        Sleep(1);
+    }
+    while (nbTouches < max && _kbhit())
+    {
+        int ch = _getch();
+        if (ch == 0 || ch == 224)
+        {
+            // Touches spéciales (flèches)
+            ch = _getch();
+            touches[nbTouches++] = ch == 72 ? CLAVIER_HAUT : ch == 80 ? CLAVIER_BAS : ch == 75 ? CLAVIER_GAUCHE : ch == 77 ? CLAVIER_DROITE : CLAVIER_AUTRE;
+        }
+        else
+        {
+            touches[nbTouches++] = ch == 27 || ch == 3 ? CLAVIER_ECHAP : CLAVIER_AUTRE;
+        }
+    }
+#else
+    unsigned char octets[TOUCHES_PAR_LOT * 4];
+    int nbOctets = 0;
+    int capacite = max < TOUCHES_PAR_LOT ? max : TOUCHES_PAR_LOT; // Au moins un octet par touche
+    int lecture = lireOctets(octets, &nbOctets, capacite, delaiMs);
+    if (lecture < 0)
+    {
+        touches[0] = CLAVIER_ECHAP;
+        return 1;
+    }
+    int i = 0;
+    while (i < nbOctets && nbTouches < max)
+    {
+        if (octets[i] != 27)
+        {
+            touches[nbTouches++] = octets[i] == 3 ? CLAVIER_ECHAP : CLAVIER_AUTRE;
+            i++;
+            continue;
+        }
+        // Echap seul, ou début d'une séquence dont la suite n'est peut-être pas encore arrivée
+        if (i + 1 >= nbOctets && lireOctets(octets, &nbOctets, sizeof(octets), DELAI_SEQUENCE_MS) <= 0)
+        {
+            touches[nbTouches++] = CLAVIER_ECHAP;
+            i++;
+            continue;
+        }
+        if (octets[i + 1] != '[' && octets[i + 1] != 'O')
+        {
+            touches[nbTouches++] = CLAVIER_ECHAP;
+            i++;
+            continue;
+        }
+        // Séquence ESC [ paramètres lettre : on avance jusqu'à la lettre finale
+        int fin = i + 2;
+        while (1)
+        {
+            while (fin < nbOctets && (octets[fin] < 0x40 || octets[fin] > 0x7E))
+            {
+                fin++;
+            }
+            if (fin < nbOctets || lireOctets(octets, &nbOctets, sizeof(octets), DELAI_SEQUENCE_MS) <= 0)
+            {
+                break;
+            }
+        }
+        if (fin >= nbOctets)
+        {
+            break; // Séquence incomplète, ignorée
+        }
+        switch (octets[fin])
+        {
+        case 'A':
+            touches[nbTouches++] = CLAVIER_HAUT;
+            break;
+        case 'B':
+            touches[nbTouches++] = CLAVIER_BAS;
+            break;
+        case 'C':
+            touches[nbTouches++] = CLAVIER_DROITE;
+            break;
+        case 'D':
+            touches[nbTouches++] = CLAVIER_GAUCHE;
+            break;
+        default:
+            touches[nbTouches++] = CLAVIER_AUTRE;
+            break;
+        }
+        i = fin + 1;
+    }
+#endif
+    return nbTouches;
+}
+
+/**
+ * Attente d'une touche quelconque.
+ */
+void attendreTouche()
+{
+    ToucheClavier touche;
+    while (lireTouches(&touche, 1, -1) == 0)
+    {
+    }
+}
+
+/**
+ * Affichage d'une ligne de l'arbre de débogage : une salle (ou un emplacement vide) à une profondeur donnée.
+ * @param labyrinthe La partie (pour la position du joueur et les visites).
+ * @param salle La salle à afficher, LABYRINTHE_AUCUNE_SALLE pour un emplacement vide.
+ * @param profondeur La profondeur de la salle.
+ * @param image Le tampon dans lequel composer l'affichage.
+ */
+void afficherLigneArbre(const Labyrinthe *labyrinthe, uint32_t salle, int profondeur, Tampon *image)
+{
+    uint32_t current = labyrinthe_position(labyrinthe);
+    // Indentation pour la profondeur
+    for (int i = 0; i < profondeur; i++)
+    {
+        tamponAjouter(image, "|   ");
+    }
+    if (salle == LABYRINTHE_AUCUNE_SALLE)
+    {
+        tamponAjouter(image, "|-- NULL\n");
+        return;
+    }
+    // Repère des salles où le joueur est, ou peut aller
+    const char *repere = salle == current                                                        ? " " RED "<- Vous etes ici" RESET
+                         : salle == labyrinthe_neighbor(labyrinthe, current, LABYRINTHE_HAUT)   ? " " GREEN "<- Parent" RESET
+                         : salle == labyrinthe_neighbor(labyrinthe, current, LABYRINTHE_GAUCHE) ? " " GREEN "<- Gauche" RESET
+                         : salle == labyrinthe_neighbor(labyrinthe, current, LABYRINTHE_DROITE) ? " " GREEN "<- Droite" RESET
+                                                                                                : "";
+    tamponAjouter(image, "|-- %c%s\n", labyrinthe_room(labyrinthe, salle), repere);
+}
+
+/**
+ * Affichage du labyrinthe de façon graphique pour le débogage.
+ * Le parcours préfixe suit les liens vers le parent, sans récursion, pour supporter les arbres très profonds.
+ * @param labyrinthe La partie (pour la position du joueur et les visites).
+ * @param salle La salle à partir de laquelle afficher, 0 pour tout le labyrinthe.
+ * @param profondeur La profondeur de la salle.
+ * @param image Le tampon dans lequel composer l'affichage.
+ */
+void afficherArbre(const Labyrinthe *labyrinthe, uint32_t salle, int profondeur, Tampon *image)
+{
+    uint32_t racine = salle;
+    if (salle == LABYRINTHE_AUCUNE_SALLE)
+    {
+        afficherLigneArbre(labyrinthe, salle, profondeur, image);
+        return;
+    }
+    while (1)
+    {
+        afficherLigneArbre(labyrinthe, salle, profondeur, image);
+
+        // On affiche les sous-arbres en commençant par le sous-arbre gauche
+        uint32_t gauche = labyrinthe_neighbor(labyrinthe, salle, LABYRINTHE_GAUCHE);
+        if (gauche != LABYRINTHE_AUCUNE_SALLE)
+        {
+            salle = gauche;
+            profondeur++;
+            continue;
+        }
+        afficherLigneArbre(labyrinthe, LABYRINTHE_AUCUNE_SALLE, profondeur + 1, image);
+
+        // puis le droit
+        uint32_t droite = labyrinthe_neighbor(labyrinthe, salle, LABYRINTHE_DROITE);
+        if (droite != LABYRINTHE_AUCUNE_SALLE)
+        {
+            salle = droite;
+            profondeur++;
+            continue;
+        }
+        afficherLigneArbre(labyrinthe, LABYRINTHE_AUCUNE_SALLE, profondeur + 1, image);
+
+        // Sous-arbre terminé : on remonte jusqu'au prochain sous-arbre droit à afficher
+        while (1)
+        {
+            if (salle == racine)
+            {
+                return;
+            }
+            uint32_t parent = labyrinthe_neighbor(labyrinthe, salle, LABYRINTHE_HAUT);
+            profondeur--;
+            if (salle == labyrinthe_neighbor(labyrinthe, parent, LABYRINTHE_GAUCHE))
+            {
+                uint32_t droiteParent = labyrinthe_neighbor(labyrinthe, parent, LABYRINTHE_DROITE);
+                if (droiteParent != LABYRINTHE_AUCUNE_SALLE)
+                {
+                    salle = droiteParent;
+                    profondeur++;
+                    break;
+                }
+                afficherLigneArbre(labyrinthe, LABYRINTHE_AUCUNE_SALLE, profondeur + 1, image); // Le parent n'a pas de fils droit
+            }
+            salle = parent;
+        }
+    }
+}
+
+/**
+ * Affichage des choix possibles pour le joueur.
+ * @param gauche Indique si le nœud actuel a un enfant gauche.
+ * @param droite Indique si le nœud actuel a un enfant droit.
+ * @param parent Indique si le nœud actuel a un parent.
+ * @param image Le tampon dans lequel composer l'affichage.
+ */
+void afficherChoix(bool gauche, bool droite, bool parent, Tampon *image)
+{
+    tamponAjouter(image, "\nChoix possibles:\n");
+    int option = 1;
+    if (gauche)
+    {
+        tamponAjouter(image, "%d. <- pour aller a gauche \n", option++);
+    }
+    if (droite)
+    {
+        tamponAjouter(image, "%d. -> pour aller a droite \n", option++);
+    }
+    if (parent)
+    {
+        tamponAjouter(image, "%d. ^ pour revenir au parent \n", option++);
+    }
+    tamponAjouter(image, "%d. Echap pour quitter\n\n", option);
+}
+
+/**
+ * Affichage du voisinage du joueur.
+ * Chaque nœud est donné par la lettre à afficher ('?' s'il n'a pas été visité), ou 0 s'il n'existe pas.
+ * @param parent Le parent du nœud actuel.
+ * @param courant Le nœud actuel.
+ * @param gauche L'enfant gauche du nœud actuel.
+ * @param droite L'enfant droit du nœud actuel.
+ * @param sortie Indique si le joueur est sur la sortie (les choix ne sont alors pas affichés).
+ * @param image Le tampon dans lequel composer l'affichage.
+ */
+void afficherVueJoueur(char parent, char courant, char gauche, char droite, bool sortie, Tampon *image)
+{
+    tamponAjouter(image, "\n=============================\n\n");
+
+    // Afficher le parent s'il existe
+    if (parent != 0)
+    {
+        tamponAjouter(image, "          [%c]\n", parent);
+        tamponAjouter(image, "           |\n");
+    }
+
+    // Afficher le nœud actuel
+    tamponAjouter(image, "          [%c] <- Vous etes ici\n", courant);
+    tamponAjouter(image, "         /   \\\n");
+
+    // Afficher les enfants
+    if (gauche != 0)
+    {
+        tamponAjouter(image, "      [%c]     ", gauche);
+        if (droite != 0)
+        {
+            tamponAjouter(image, "[%c]\n", droite);
+        }
+        else
+        {
+            tamponAjouter(image, "      \n");
+        }
+    }
+    else if (droite != 0)
+    {
+        tamponAjouter(image, "              [%c]\n", droite);
+    }
+    else
+    {
+        tamponAjouter(image, "               \n");
+    }
+
+    // si on est à la sortie, on affiche pas les choix possibles
+    if (sortie)
+    {
+        return;
+    }
+    afficherChoix(gauche != 0, droite != 0, parent != 0, image);
+}
+
+/**
+ * Affichage du voisinage du joueur, tel qu'il le voit.
+ * @param labyrinthe La partie.
+ * @param sortie Indique si le joueur est sur la sortie (les choix ne sont alors pas affichés).
+ * @param image Le tampon dans lequel composer l'affichage.
+ */
+void afficherVueLabyrinthe(const Labyrinthe *labyrinthe, bool sortie, Tampon *image)
+{
+    uint32_t current = labyrinthe_position(labyrinthe);
+    afficherVueJoueur(labyrinthe_room(labyrinthe, labyrinthe_neighbor(labyrinthe, current, LABYRINTHE_HAUT)),
+                      labyrinthe_room(labyrinthe, current),
+                      labyrinthe_room(labyrinthe, labyrinthe_neighbor(labyrinthe, current, LABYRINTHE_GAUCHE)),
+                      labyrinthe_room(labyrinthe, labyrinthe_neighbor(labyrinthe, current, LABYRINTHE_DROITE)), sortie, image);
+}
+
+/**
+ * Affichage des règles du jeu.
+ */
+void afficherReglesDuJeu()
+{
+    printf("Bienvenue dans le jeu du labyrinthe !\n");
+    printf("Voici les regles du jeu :\n");
+    printf("1. Vous commencez a l'entree du labyrinthe (E).\n");
+    printf("2. Votre objectif est de trouver la sortie (S).\n");
+    printf("3. Vous pouvez vous déplacer vers la gauche ou la droite.\n");
+    printf("4. Faites attention aux différents événements que vous pouvez rencontrer :\n");
+
+    // Afficher les différents événements
+    char lettre;
+    const char *description;
+    for (uint32_t i = 0; (description = labyrinthe_event_type(i, &lettre)) != NULL; i++)
+    {
+        printf("   - %c : %s\n", lettre, description);
+    }
+
+    printf("5. Les noeuds non explorés sont marqués par un point d'interrogation (?).\n");
+    printf("6. Bonne chance et amusez-vous bien !\n");
+}
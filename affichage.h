@@ -0,0 +1,66 @@
+/**
+ * @file affichage.h
+ * @brief Déclarations de l'affichage et du clavier du jeu du labyrinthe
+ *
+ * L'affichage est la partie terminal du menu (main.c) : il compose les images, ne réécrit que les lignes
+ * qui changent et décode les touches. Il ne connaît la partie que par le moteur (labyrinthe.h).
+ *
+ * Les structures principales incluent :
+ * - Ecran : État du terminal, pour ne redessiner que les lignes modifiées.
+ * - ToucheClavier : Touche du clavier décodée, indépendamment du terminal.
+ *
+ * @note Utilisation du compilateur GCC.
+ */
+
+#ifndef AFFICHAGE_H
+#define AFFICHAGE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "labyrinthe.h"
+#include "tampon.h"
+
+// Couleurs pour l'affichage
+#define GREEN "\033[1;32m"
+#define RED "\033[1;31m"
+#define RESET "\033[0m"
+
+typedef struct Ecran // Contenu actuel du terminal, pour ne réécrire que les lignes qui changent
+{
+    Tampon affichee;     // Dernière image affichée
+    Tampon sequences;    // Séquences d'échappement et lignes à écrire pour passer à la nouvelle image
+    bool pret;           // Faux tant que le terminal n'a pas été effacé
+    int lignesModifiees; // Nombre de lignes réécrites pour la dernière image
+} Ecran;
+
+typedef enum ToucheClavier // Touches reconnues par le jeu
+{
+    CLAVIER_AUTRE,
+    CLAVIER_HAUT,
+    CLAVIER_BAS,
+    CLAVIER_GAUCHE,
+    CLAVIER_DROITE,
+    CLAVIER_ECHAP
+} ToucheClavier;
+
+#define TOUCHES_PAR_LOT 64            // Nombre maximum de touches jouées avant de redessiner
+#define DELAI_RAFRAICHISSEMENT_MS 500 // Sans touche, on redessine quand même (changement de taille du terminal)
+#define DELAI_SEQUENCE_MS 25          // Attente de la suite d'une séquence d'échappement coupée
+
+void effacerEcran();
+void ecranAfficher(Ecran *ecran, Tampon *image, FILE *flux);
+void ecranLiberer(Ecran *ecran);
+void clavierActiver();
+void clavierRestaurer();
+int lireTouches(ToucheClavier *touches, int max, int delaiMs);
+void attendreTouche();
+void afficherLigneArbre(const Labyrinthe *labyrinthe, uint32_t salle, int profondeur, Tampon *image);
+void afficherArbre(const Labyrinthe *labyrinthe, uint32_t salle, int profondeur, Tampon *image);
+void afficherChoix(bool gauche, bool droite, bool parent, Tampon *image);
+void afficherVueJoueur(char parent, char courant, char gauche, char droite, bool sortie, Tampon *image);
+void afficherVueLabyrinthe(const Labyrinthe *labyrinthe, bool sortie, Tampon *image);
+void afficherReglesDuJeu();
+
+#endif // AFFICHAGE_H
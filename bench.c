@@ -0,0 +1,528 @@
+/**
+ * @file bench.c
+ * @brief Mesures de performance du moteur du labyrinthe
+ *
+ * Ce programme mesure, sans interaction, le temps des fonctions principales de toolBox.c
+ * pour des arbres de 10 à 10^7 nœuds, générés avec des graines fixes :
+ * - genererArbre et genererArbreCompact : génération de l'arbre, par descente et par l'algorithme de Rémy.
+ * - genererArbreCompactParallele : génération d'un arbre compact avec ses événements, sur tous les cœurs.
+ * - ouvrirLabyrinthe : réouverture d'un labyrinthe sauvegardé (fichier temporaire dans le dossier courant).
+ * - genererEventsCompact : placement des événements.
+ * - compterNoeudsNonExploresCompact : parcours du bitset des visites.
+ * - resoudreLabyrintheCompact : recherche du plus court parcours jusqu'à la sortie.
+ * - afficherArbre : affichage de débogage (affichage.c), composé dans un tampon en mémoire.
+ * - exporterArbreCompact : export GraphViz (DOT) et JSON lines, écrit dans un puits (/dev/null).
+ * - rand et aleaBorne : débit des tirages aléatoires bornés.
+ * - tirerEvent et tirerEvents : tirage pondéré des événements, seul puis mélangé pour tout un arbre.
+ * - rejouerJournal : débit de la relecture d'un journal de partie, en mouvements.
+ * - labyrinthe_step : coût d'un mouvement joué avec le moteur sans affichage (labyrinthe.h).
+ * - labyrinthe_join : parties qui partagent un labyrinthe de 10^7 salles, avec la mémoire propre à chacune.
+ * - typeEvent : coût d'application des règles d'un événement, tiré parmi tous les types.
+ *
+ * Contrairement aux autres programmes, qui ne voient que labyrinthe.h et sont liés à la bibliothèque labyrinthe,
+ * le bench compile lui-même les sources du moteur et de l'affichage : il compte leurs allocations et mesure
+ * des fonctions internes (génération, parcours, tirages) qui ne sont pas dans l'interface.
+ *
+ * Chaque mesure est écrite sur une ligne JSON (temps par nœud, nombre d'allocations, pic de mémoire)
+ * pour pouvoir comparer chaque modification à une référence.
+ *
+ * Utilisation : labyrinthe_bench [taille_max]
+ *
+ * @note Utilisation du compilateur GCC.
+ */
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+static _Atomic long nbAllocations = 0; // Nombre d'appels à malloc et calloc, depuis tous les threads
+
+static void *mallocCompte(size_t taille)
+{
+    nbAllocations++;
+    return malloc(taille);
+}
+
+static void *callocCompte(size_t nombre, size_t taille)
+{
+    nbAllocations++;
+    return calloc(nombre, taille);
+}
+
+// Les allocations de toolBox.c passent par les compteurs ci-dessus
+#define malloc(taille) mallocCompte(taille)
+#define calloc(nombre, taille) callocCompte(nombre, taille)
+#include "labyrinthe.c"
+#undef malloc
+#undef calloc
+#include "affichage.c"
+
+// Au-delà de cette taille, l'affichage de débogage (une ligne indentée par nœud et par emplacement vide) n'est plus mesuré
+#define TAILLE_MAX_AFFICHAGE 100000
+
+// Fichier temporaire pour mesurer la réouverture d'un labyrinthe sauvegardé
+#define FICHIER_BENCH "labyrinthe_bench.laby"
+
+// Puits dans lequel on écrit les exports, pour ne mesurer que leur composition
+#ifdef _WIN32
+#define FICHIER_NUL "NUL"
+#else
+#define FICHIER_NUL "/dev/null"
+#endif
+
+/**
+ * Pic de mémoire résidente du processus.
+ * @return le pic en kilo-octets.
+ */
+static long picMemoireKo()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS compteurs;
+    GetProcessMemoryInfo(GetCurrentProcess(), &compteurs, sizeof(compteurs));
+    return (long)(compteurs.PeakWorkingSetSize / 1024);
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss; // En kilo-octets sous Linux
+#endif
+}
+
+/**
+ * Écriture d'une mesure sur une ligne JSON.
+ * @param fonction Le nom de la fonction mesurée.
+ * @param taille Le nombre de nœuds de l'arbre.
+ * @param graine La graine utilisée pour générer l'arbre.
+ * @param repetitions Le nombre d'appels mesurés.
+ * @param dureeNs La durée totale des appels.
+ * @param allocations Le nombre total d'allocations faites par les appels.
+ */
+static void rapporter(const char *fonction, int taille, unsigned int graine, int repetitions, double dureeNs, long allocations)
+{
+    printf("{\"fonction\":\"%s\",\"taille\":%d,\"graine\":%u,\"repetitions\":%d,"
+           "\"ns_par_appel\":%.1f,\"ns_par_noeud\":%.3f,\"allocations_par_appel\":%.1f,\"rss_max_ko\":%ld}\n",
+           fonction, taille, graine, repetitions, dureeNs / repetitions, dureeNs / repetitions / taille,
+           (double)allocations / repetitions, picMemoireKo());
+    fflush(stdout);
+}
+
+/**
+ * Génération d'un arbre compact complet (forme et événements) pour les mesures de parcours.
+ * @param taille Le nombre de nœuds.
+ * @param graine La graine aléatoire.
+ * @return l'arbre généré, le joueur à l'entrée.
+ */
+static ArbreCompact *preparerArbre(int taille, unsigned int graine)
+{
+    Alea alea;
+    aleaInit(&alea, graine);
+    ArbreCompact *arbre = genererArbreCompact(taille, &alea);
+    genererEventsCompact(arbre, &alea);
+    return arbre;
+}
+
+/**
+ * Mesure de toutes les fonctions pour une taille d'arbre donnée.
+ * @param taille Le nombre de nœuds.
+ * @param graine La graine aléatoire.
+ */
+static void mesurerTaille(int taille, unsigned int graine)
+{
+    // Plus l'arbre est petit, plus on répète les appels pour obtenir une durée mesurable
+    int repetitions = taille >= 100000 ? 1 : 100000 / taille;
+    double debut, duree;
+    long allocations;
+
+    // Génération par descente depuis la racine
+    duree = 0;
+    allocations = 0;
+    for (int r = 0; r < repetitions; r++)
+    {
+        Alea alea;
+        aleaInit(&alea, graine);
+        Arbre *arbre = init();
+        long avant = nbAllocations;
+        debut = maintenantNs();
+        genererArbre(arbre, taille, &alea);
+        duree += maintenantNs() - debut;
+        allocations += nbAllocations - avant;
+        detruireArbre(arbre);
+    }
+    rapporter("genererArbre", taille, graine, repetitions, duree, allocations);
+
+    // Génération linéaire, directement en représentation compacte
+    duree = 0;
+    allocations = 0;
+    for (int r = 0; r < repetitions; r++)
+    {
+        Alea alea;
+        aleaInit(&alea, graine);
+        long avant = nbAllocations;
+        debut = maintenantNs();
+        ArbreCompact *compact = genererArbreCompact(taille, &alea);
+        duree += maintenantNs() - debut;
+        allocations += nbAllocations - avant;
+        detruireArbreCompact(compact);
+    }
+    rapporter("genererArbreCompact", taille, graine, repetitions, duree, allocations);
+
+    // Génération parallèle d'un arbre compact, forme et événements
+    duree = 0;
+    allocations = 0;
+    for (int r = 0; r < repetitions; r++)
+    {
+        Alea alea;
+        aleaInit(&alea, graine);
+        long avant = nbAllocations;
+        debut = maintenantNs();
+        Decoupage decoupage;
+        ArbreCompact *compact = genererArbreCompactParallele(taille, nombreCoeurs(), &alea, &decoupage);
+        genererEventsCompactParallele(compact, &decoupage, nombreCoeurs(), &alea);
+        duree += maintenantNs() - debut;
+        allocations += nbAllocations - avant;
+        libererDecoupage(&decoupage);
+        detruireArbreCompact(compact);
+    }
+    rapporter("genererArbreCompactParallele", taille, graine, repetitions, duree, allocations);
+
+    // Réouverture d'un labyrinthe sauvegardé, projeté en mémoire sans être relu
+    {
+        Alea alea;
+        aleaInit(&alea, graine);
+        ArbreCompact *compact = genererArbreCompact(taille, &alea);
+        genererEventsCompact(compact, &alea);
+        bool sauvegarde = sauvegarderLabyrinthe(compact, FICHIER_BENCH);
+        detruireArbreCompact(compact);
+        if (sauvegarde)
+        {
+            duree = 0;
+            allocations = 0;
+            for (int r = 0; r < repetitions; r++)
+            {
+                long avant = nbAllocations;
+                debut = maintenantNs();
+                compact = ouvrirLabyrinthe(FICHIER_BENCH);
+                duree += maintenantNs() - debut;
+                allocations += nbAllocations - avant;
+                detruireArbreCompact(compact);
+            }
+            rapporter("ouvrirLabyrinthe", taille, graine, repetitions, duree, allocations);
+            remove(FICHIER_BENCH);
+        }
+    }
+
+    // Placement des événements, sur un arbre neuf à chaque fois
+    duree = 0;
+    allocations = 0;
+    for (int r = 0; r < repetitions; r++)
+    {
+        Alea alea;
+        aleaInit(&alea, graine);
+        ArbreCompact *compact = genererArbreCompact(taille, &alea);
+        long avant = nbAllocations;
+        debut = maintenantNs();
+        genererEventsCompact(compact, &alea);
+        duree += maintenantNs() - debut;
+        allocations += nbAllocations - avant;
+        detruireArbreCompact(compact);
+    }
+    rapporter("genererEventsCompact", taille, graine, repetitions, duree, allocations);
+
+    // Parcours, répétés sur le même arbre
+    ArbreCompact *arbre = preparerArbre(taille, graine);
+    volatile int resultat = 0; // Empêche le compilateur de supprimer les appels
+
+    debut = maintenantNs();
+    for (int r = 0; r < repetitions; r++)
+    {
+        resultat += compterNoeudsNonExploresCompact(arbre);
+    }
+    rapporter("compterNoeudsNonExploresCompact", taille, graine, repetitions, maintenantNs() - debut, 0);
+
+    duree = 0;
+    allocations = 0;
+    for (int r = 0; r < repetitions; r++)
+    {
+        long avant = nbAllocations;
+        debut = maintenantNs();
+        Solution solution = resoudreLabyrintheCompact(arbre);
+        duree += maintenantNs() - debut;
+        allocations += nbAllocations - avant;
+        resultat += solution.nbMouvements;
+        libererSolution(&solution);
+    }
+    rapporter("resoudreLabyrintheCompact", taille, graine, repetitions, duree, allocations);
+
+    // Affichage de débogage dans un tampon en mémoire
+    if (taille <= TAILLE_MAX_AFFICHAGE)
+    {
+        Tampon puits = {0};
+        Labyrinthe *vue = commencerLabyrinthe(preparerArbre(taille, graine), graine, 0); // Le même arbre, vu par l'affichage
+        duree = 0;
+        for (int r = 0; r < repetitions; r++)
+        {
+            puits.taille = 0;
+            puits.debutNs = 0;
+            debut = maintenantNs();
+            afficherArbre(vue, 0, 0, &puits);
+            duree += maintenantNs() - debut;
+        }
+        rapporter("afficherArbre", taille, graine, repetitions, duree, 0);
+        tamponLiberer(&puits);
+        labyrinthe_free(vue);
+    }
+
+    // Exports vers des outils externes, en mémoire bornée quelle que soit la taille
+    FILE *nul = fopen(FICHIER_NUL, "wb");
+    if (nul != NULL)
+    {
+        const char *noms[] = {"exporterArbreCompactDot", "exporterArbreCompactJson"};
+        for (FormatExport format = EXPORT_DOT; format <= EXPORT_JSON; format++)
+        {
+            duree = 0;
+            allocations = 0;
+            for (int r = 0; r < repetitions; r++)
+            {
+                long avant = nbAllocations;
+                debut = maintenantNs();
+                exporterArbreCompact(arbre, format, nul);
+                duree += maintenantNs() - debut;
+                allocations += nbAllocations - avant;
+            }
+            rapporter(noms[format], taille, graine, repetitions, duree, allocations);
+        }
+        fclose(nul);
+    }
+    detruireArbreCompact(arbre);
+}
+
+/**
+ * Mesure du débit des tirages bornés, avec rand() % borne et avec aleaBorne,
+ * puis du tirage pondéré des événements.
+ * @param graine La graine aléatoire.
+ */
+static void mesurerTirages(unsigned int graine)
+{
+    const int nbTirages = 10000000;
+    volatile uint32_t resultat = 0; // Empêche le compilateur de supprimer les tirages
+    double debut;
+
+    srand(graine);
+    debut = maintenantNs();
+    for (int i = 0; i < nbTirages; i++)
+    {
+        resultat += rand() % (uint32_t)(i % 1000 + 1);
+    }
+    rapporter("rand", 1, graine, nbTirages, maintenantNs() - debut, 0);
+
+    Alea alea;
+    aleaInit(&alea, graine);
+    debut = maintenantNs();
+    for (int i = 0; i < nbTirages; i++)
+    {
+        resultat += aleaBorne(&alea, (uint32_t)(i % 1000 + 1));
+    }
+    rapporter("aleaBorne", 1, graine, nbTirages, maintenantNs() - debut, 0);
+
+    TirageEvents tirage;
+    initTirageEvents(&tirage);
+    debut = maintenantNs();
+    for (int i = 0; i < nbTirages; i++)
+    {
+        resultat += (uint32_t)tirerEvent(&tirage, (uint64_t)(nbTirages - i), &alea);
+    }
+    rapporter("tirerEvent", 1, graine, nbTirages, maintenantNs() - debut, 0);
+
+    char *events = malloc(nbTirages);
+    if (events == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour les événements");
+        exit(EXIT_FAILURE);
+    }
+    debut = maintenantNs();
+    tirerEvents(events, nbTirages, &alea);
+    rapporter("tirerEvents", nbTirages, graine, 1, maintenantNs() - debut, 0);
+    free(events);
+}
+
+/**
+ * Mesure du coût d'application des règles d'un événement (typeEvent puis sa règle d'entrée),
+ * sur des salles dont le type est tiré uniformément parmi eventTypes.
+ * @param graine La graine aléatoire.
+ */
+static void mesurerEvents(unsigned int graine)
+{
+    const int nbSalles = 1 << 20;
+    const int nbTypes = sizeof(eventTypes) / sizeof(eventTypes[0]);
+    char *events = malloc(nbSalles);
+    if (events == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour les salles");
+        exit(EXIT_FAILURE);
+    }
+    Alea alea;
+    aleaInit(&alea, graine);
+    for (int i = 0; i < nbSalles; i++)
+    {
+        events[i] = eventTypes[aleaBorne(&alea, nbTypes)].letter;
+    }
+    volatile int resultat = 0; // Empêche le compilateur de supprimer les appels
+    const int repetitions = 10;
+    double debut = maintenantNs();
+    for (int r = 0; r < repetitions; r++)
+    {
+        for (int i = 0; i < nbSalles; i++)
+        {
+            const EventType *type = typeEvent(events[i]);
+            if (type->entrer != NULL)
+            {
+                EtatSalle salle = {(i & 1) != 0, (i & 2) != 0, NULL};
+                resultat += type->entrer(&salle);
+            }
+        }
+    }
+    rapporter("typeEvent", 1, graine, repetitions * nbSalles, maintenantNs() - debut, 0);
+    free(events);
+}
+
+/**
+ * Mesure du débit de rejouerJournal, sur le journal d'une marche au hasard dans un grand labyrinthe.
+ * @param graine La graine aléatoire.
+ */
+static void mesurerJournal(unsigned int graine)
+{
+    const uint32_t nbMouvementsMax = 10000000;
+    Alea alea;
+    aleaInit(&alea, graine);
+    ArbreCompact *arbre = genererLabyrintheCompact(1000000, GENERATION_LINEAIRE, &alea);
+    Partie partie;
+    initPartie(&partie, arbre, graine);
+    Journal journal = {0};
+    journalCommencer(&journal, graine);
+    static const Touche touches[] = {TOUCHE_HAUT, TOUCHE_GAUCHE, TOUCHE_DROITE};
+    while (journal.nbMouvements < nbMouvementsMax && !partie.gagnee)
+    {
+        jouerPartieJournal(&partie, touches[aleaBorne(&alea, 3)], &journal);
+    }
+    terminerJournal(&journal, &partie);
+
+    long avant = nbAllocations;
+    double debut = maintenantNs();
+    bool identique = rejouerJournal(&partie, &journal);
+    double duree = maintenantNs() - debut;
+    if (identique && journal.nbMouvements > 0)
+    {
+        rapporter("rejouerJournal", 1, graine, journal.nbMouvements, duree, nbAllocations - avant);
+    }
+    else
+    {
+        fprintf(stderr, "rejouerJournal : la partie rejouee s'ecarte du journal\n");
+    }
+    libererJournal(&journal);
+    libererPartie(&partie);
+    detruireArbreCompact(arbre);
+}
+
+/**
+ * Mesure du coût d'un mouvement avec le moteur sans affichage, au hasard dans un grand labyrinthe,
+ * en recommençant la partie quand la sortie est trouvée.
+ * @param graine La graine aléatoire.
+ */
+static void mesurerLabyrinthe(unsigned int graine)
+{
+    const int nbPas = 10000000;
+    Labyrinthe *labyrinthe = labyrinthe_new(graine, 1000000, LABYRINTHE_EVENEMENTS);
+    Alea alea;
+    aleaInit(&alea, graine);
+    long avant = nbAllocations;
+    double debut = maintenantNs();
+    for (int i = 0; i < nbPas; i++)
+    {
+        if (labyrinthe_step(labyrinthe, (MouvementLabyrinthe)aleaBorne(&alea, 3)) == LABYRINTHE_GAGNE)
+        {
+            labyrinthe_reset(labyrinthe, aleaSuivant(&alea));
+        }
+    }
+    rapporter("labyrinthe_step", 1, graine, nbPas, maintenantNs() - debut, nbAllocations - avant);
+    labyrinthe_free(labyrinthe);
+}
+
+/**
+ * Mesure de nombreuses parties sur un même labyrinthe de 10^7 salles, jouées tour à tour comme sur le serveur :
+ * coût d'une partie de plus (labyrinthe_join), d'un mouvement, et mémoire des visites propres à chaque partie.
+ * @param graine La graine aléatoire.
+ */
+static void mesurerParties(unsigned int graine)
+{
+    const int nbParties = 10000, nbTours = 100;
+    Labyrinthe *modele = labyrinthe_new(graine, 10000000, LABYRINTHE_EVENEMENTS | LABYRINTHE_PARALLELE);
+    Labyrinthe **parties = malloc(nbParties * sizeof(Labyrinthe *));
+    if (parties == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour les parties");
+        exit(EXIT_FAILURE);
+    }
+    Alea alea;
+    aleaInit(&alea, graine);
+    long avant = nbAllocations;
+    double debut = maintenantNs();
+    for (int i = 0; i < nbParties; i++)
+    {
+        parties[i] = labyrinthe_join(modele, aleaSuivant(&alea), 0);
+    }
+    rapporter("labyrinthe_join", 10000000, graine, nbParties, maintenantNs() - debut, nbAllocations - avant);
+
+    avant = nbAllocations;
+    debut = maintenantNs();
+    for (int tour = 0; tour < nbTours; tour++)
+    {
+        for (int i = 0; i < nbParties; i++)
+        {
+            labyrinthe_step(parties[i], (MouvementLabyrinthe)aleaBorne(&alea, 3));
+        }
+    }
+    rapporter("labyrinthe_step partagé", 10000000, graine, nbParties * nbTours, maintenantNs() - debut,
+              nbAllocations - avant);
+
+    size_t octets = 0;
+    for (int i = 0; i < nbParties; i++)
+    {
+        const Visites *visites = &parties[i]->partie.visites;
+        octets += visites->bits != NULL ? (visites->taille + 63) / 64 * sizeof(uint64_t)
+                                        : visites->capacite * sizeof(uint32_t);
+    }
+    printf("{\"fonction\":\"visites par partie\",\"taille\":%d,\"parties\":%d,\"octets_par_partie\":%.1f,"
+           "\"octets_labyrinthe\":%zu}\n",
+           10000000, nbParties, (double)octets / nbParties, (size_t)10000000 * 13 + 10000000 / 8);
+    fflush(stdout);
+
+    labyrinthe_free(modele); // Le labyrinthe reste à ses autres parties
+    for (int i = 0; i < nbParties; i++)
+    {
+        labyrinthe_free(parties[i]);
+    }
+    free(parties);
+}
+
+int main(int argc, char **argv)
+{
+    int tailleMax = argc > 1 ? atoi(argv[1]) : 10000000;
+    unsigned int graine = 12122024; // Graine fixe pour des mesures reproductibles
+
+    mesurerTirages(graine);
+    mesurerEvents(graine);
+    mesurerJournal(graine);
+    mesurerLabyrinthe(graine);
+    mesurerParties(graine);
+    for (int taille = 10; taille <= tailleMax; taille *= 10)
+    {
+        mesurerTaille(taille, graine);
+    }
+    return 0;
+}
@@ -0,0 +1,403 @@
+/**
+ * @file charge.c
+ * @brief Client de charge du serveur de parties
+ *
+ * Ce programme ouvre un grand nombre de sessions sur labyrinthe_serveur (voir serveur.h) et y joue au hasard,
+ * comme autant de joueurs : chaque session envoie un mouvement toutes les INTERVALLE ms, décalée des autres,
+ * et recommence sa partie quand elle trouve la sortie. Avec --intervalle 0, chaque session renvoie un mouvement
+ * dès qu'elle reçoit la réponse au précédent, pour mesurer le débit maximum du serveur.
+ *
+ * Une session n'a jamais qu'une commande en cours : un mouvement prévu pendant qu'une réponse est attendue
+ * est mis en file et compté comme en retard, puis envoyé dès la réponse. La latence est mesurée depuis l'heure
+ * prévue du mouvement, et non depuis son envoi : l'attente d'un serveur lent compte ainsi pour tous les mouvements
+ * qu'il a retardés (pas d'omission coordonnée). Les latences de toutes les sessions sont triées à la fin :
+ * médiane, p99, p99.9 et maximum, affichés puis écrits sur une ligne JSON comme dans bench.c.
+ *
+ * Utilisation : labyrinthe_charge [--socket CHEMIN] [--sessions N] [--mouvements M] [--intervalle MS]
+ *                                 [--threads K] [--graine G]
+ *
+ * @note Utilisation du compilateur GCC, sous Linux (epoll).
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "labyrinthe.h"
+#include "serveur.h"
+
+#define EVENEMENTS_PAR_ATTENTE 256 // Réponses traitées par appel à epoll_wait
+
+typedef struct Charge // Paramètres partagés par tous les threads
+{
+    const char *chemin;
+    uint32_t nbMouvements; // Mouvements par session
+    double intervalleNs;   // Entre deux mouvements d'une session, 0 pour enchaîner
+    uint64_t graine;
+} Charge;
+
+typedef struct Joueur // Une session du client
+{
+    int fd;
+    bool enAttente;         // Une commande attend sa réponse
+    bool recommencer;       // La sortie est trouvée : la prochaine commande recommence la partie
+    uint32_t recus;         // Octets reçus de la réponse en cours
+    uint32_t restants;      // Mouvements encore à envoyer
+    uint32_t enFile;        // Mouvements prévus, en attente de la réponse à la commande en cours
+    double fileNs;          // Instant prévu du plus ancien mouvement en file
+    double prevuNs;         // Instant prévu de la commande en cours, d'où part sa latence
+    double prochainNs;      // Instant prévu du prochain mouvement
+    ReponseServeur reponse; // Réponse en cours de réception
+    uint64_t alea;          // Générateur des mouvements de la session (labyrinthe_random)
+} Joueur;
+
+typedef struct Injecteur // Un thread, ses sessions et leurs latences
+{
+    const Charge *charge;
+    int premier;        // Numéro de sa première session
+    int nbJoueurs;
+    Joueur *joueurs;
+    uint32_t *latences; // En nanosecondes, une par mouvement
+    uint64_t nbLatences;
+    uint64_t retards;   // Mouvements mis en file car la réponse précédente n'était pas arrivée
+    bool erreur;
+    pthread_t thread;
+} Injecteur;
+
+/**
+ * Autant de descripteurs que le système le permet : une connexion par session.
+ */
+static void augmenterDescripteurs()
+{
+    struct rlimit limite;
+    if (getrlimit(RLIMIT_NOFILE, &limite) == 0)
+    {
+        limite.rlim_cur = limite.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limite);
+    }
+}
+
+/**
+ * Connexion d'une session au serveur.
+ * @param chemin Le chemin de la socket.
+ * @return le descripteur de la connexion, non bloquante, -1 en cas d'erreur.
+ */
+static int connecter(const char *chemin)
+{
+    struct sockaddr_un adresse = {.sun_family = AF_UNIX};
+    strncpy(adresse.sun_path, chemin, sizeof(adresse.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    // Connexion bloquante : si la file d'attente du serveur est pleine, on attend qu'il accepte
+    if (fd < 0 || connect(fd, (struct sockaddr *)&adresse, sizeof(adresse)) < 0)
+    {
+        perror("Erreur de connexion au serveur");
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+    int options = fcntl(fd, F_GETFL);
+    fcntl(fd, F_SETFL, options | O_NONBLOCK);
+    return fd;
+}
+
+/**
+ * Envoi de la prochaine commande d'une session : un mouvement au hasard, ou une nouvelle partie après la sortie.
+ * @param joueur La session.
+ * @param prevuNs L'instant auquel la commande était prévue.
+ * @return false si la connexion est perdue.
+ */
+static bool envoyer(Joueur *joueur, double prevuNs)
+{
+    static const uint8_t mouvements[] = {COMMANDE_HAUT, COMMANDE_GAUCHE, COMMANDE_DROITE};
+    uint8_t commande = joueur->recommencer ? COMMANDE_RECOMMENCER : mouvements[((labyrinthe_random(&joueur->alea) >> 32) * 3) >> 32];
+    joueur->prevuNs = prevuNs;
+    if (send(joueur->fd, &commande, 1, MSG_NOSIGNAL) != 1)
+    {
+        return false; // Une commande d'un octet tient toujours dans la socket : ce n'est pas un simple blocage
+    }
+    joueur->enAttente = true;
+    joueur->recus = 0;
+    joueur->restants--;
+    return true;
+}
+
+/**
+ * Réception de la réponse d'une session, éventuellement en plusieurs morceaux.
+ * @param joueur La session.
+ * @param injecteur Le thread, qui garde la latence.
+ * @return false si la connexion est perdue.
+ */
+static bool recevoir(Joueur *joueur, Injecteur *injecteur)
+{
+    while (joueur->recus < sizeof(ReponseServeur))
+    {
+        ssize_t lus = recv(joueur->fd, (char *)&joueur->reponse + joueur->recus, sizeof(ReponseServeur) - joueur->recus, 0);
+        if (lus <= 0)
+        {
+            return lus < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+        }
+        joueur->recus += (uint32_t)lus;
+    }
+    double latence = labyrinthe_clock() - joueur->prevuNs;
+    injecteur->latences[injecteur->nbLatences++] = latence < UINT32_MAX ? (uint32_t)latence : UINT32_MAX;
+    joueur->enAttente = false;
+    joueur->recommencer = joueur->reponse.resultat == REPONSE_GAGNE;
+    return true;
+}
+
+/**
+ * Travail d'un thread : connecter ses sessions, puis jouer tous leurs mouvements.
+ * @param argument L'Injecteur du thread.
+ * @return NULL.
+ */
+static void *injecter(void *argument)
+{
+    Injecteur *injecteur = argument;
+    const Charge *charge = injecteur->charge;
+    int nbJoueurs = injecteur->nbJoueurs;
+    int epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll < 0)
+    {
+        perror("Erreur de création de l'instance epoll");
+        injecteur->erreur = true;
+        return NULL;
+    }
+    for (int j = 0; j < nbJoueurs; j++)
+    {
+        Joueur *joueur = &injecteur->joueurs[j];
+        joueur->fd = connecter(charge->chemin);
+        if (joueur->fd < 0)
+        {
+            injecteur->erreur = true;
+            nbJoueurs = j; // On ne joue qu'avec les sessions ouvertes
+            break;
+        }
+        joueur->restants = charge->nbMouvements;
+        joueur->alea = charge->graine ^ ((uint64_t)(injecteur->premier + j) * 0xD1B54A32D192ED03ull);
+        struct epoll_event evenement = {.events = EPOLLIN, .data.u32 = (uint32_t)j};
+        epoll_ctl(epoll, EPOLL_CTL_ADD, joueur->fd, &evenement);
+    }
+
+    // Les sessions jouent tour à tour, décalées régulièrement dans l'intervalle
+    double debut = labyrinthe_clock();
+    for (int j = 0; j < nbJoueurs; j++)
+    {
+        injecteur->joueurs[j].prochainNs = debut + charge->intervalleNs * j / (nbJoueurs > 0 ? nbJoueurs : 1);
+    }
+    int suivant = 0;                                              // Prochaine session prévue
+    uint64_t aJouer = (uint64_t)nbJoueurs * charge->nbMouvements; // Réponses encore attendues
+    uint64_t prevus = charge->intervalleNs > 0 ? aJouer : 0;      // Mouvements encore à envoyer à l'heure
+    struct epoll_event evenements[EVENEMENTS_PAR_ATTENTE];
+    if (charge->intervalleNs == 0)
+    {
+        for (int j = 0; j < nbJoueurs; j++)
+        {
+            if (charge->nbMouvements > 0 && !envoyer(&injecteur->joueurs[j], labyrinthe_clock()))
+                injecteur->erreur = true;
+        }
+    }
+    while (aJouer > 0 && !injecteur->erreur)
+    {
+        // Envoi des mouvements dont l'heure est passée
+        int delaiMs = -1;
+        double maintenant = labyrinthe_clock();
+        while (prevus > 0)
+        {
+            Joueur *joueur = &injecteur->joueurs[suivant];
+            if (joueur->prochainNs > maintenant)
+            {
+                delaiMs = (int)((joueur->prochainNs - maintenant) / 1e6) + 1;
+                break;
+            }
+            if (joueur->restants > joueur->enFile)
+            {
+                if (joueur->enAttente)
+                {
+                    injecteur->retards++;
+                    if (joueur->enFile++ == 0)
+                    {
+                        joueur->fileNs = joueur->prochainNs; // Les suivants sont prévus un intervalle plus tard chacun
+                    }
+                }
+                else if (!envoyer(joueur, joueur->prochainNs))
+                {
+                    injecteur->erreur = true;
+                    break;
+                }
+                prevus--;
+            }
+            joueur->prochainNs += charge->intervalleNs;
+            suivant = (suivant + 1) % nbJoueurs;
+        }
+
+        int nbPretes = epoll_wait(epoll, evenements, EVENEMENTS_PAR_ATTENTE, delaiMs);
+        for (int i = 0; i < nbPretes; i++)
+        {
+            Joueur *joueur = &injecteur->joueurs[evenements[i].data.u32];
+            if (!joueur->enAttente)
+            {
+                continue;
+            }
+            if (!recevoir(joueur, injecteur))
+            {
+                fprintf(stderr, "Connexion perdue avec le serveur\n");
+                injecteur->erreur = true;
+                break;
+            }
+            if (!joueur->enAttente)
+            {
+                aJouer--;
+                // Sans intervalle, le mouvement suivant part aussitôt ; sinon, le plus ancien mouvement en file
+                // part maintenant, sa latence comptée depuis son heure prévue
+                bool envoye = true;
+                if (charge->intervalleNs == 0 && joueur->restants > 0)
+                {
+                    envoye = envoyer(joueur, labyrinthe_clock());
+                }
+                else if (joueur->enFile > 0)
+                {
+                    envoye = envoyer(joueur, joueur->fileNs);
+                    joueur->fileNs += charge->intervalleNs;
+                    joueur->enFile--;
+                }
+                if (!envoye)
+                {
+                    injecteur->erreur = true;
+                }
+            }
+        }
+    }
+
+    for (int j = 0; j < nbJoueurs; j++)
+    {
+        close(injecteur->joueurs[j].fd);
+    }
+    close(epoll);
+    return NULL;
+}
+
+/**
+ * Comparaison de deux latences, pour qsort.
+ * @param a La première latence.
+ * @param b La seconde latence.
+ * @return un entier négatif, nul ou positif.
+ */
+static int comparerLatences(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char **argv)
+{
+    Charge charge = {CHEMIN_SOCKET, 100, 100e6, 12122024};
+    int nbSessions = 10000;
+    int nbThreads = labyrinthe_threads();
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool valeur = i + 1 < argc;
+        if (strcmp(argv[i], "--socket") == 0 && valeur)
+            charge.chemin = argv[++i];
+        else if (strcmp(argv[i], "--sessions") == 0 && valeur)
+            nbSessions = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--mouvements") == 0 && valeur)
+            charge.nbMouvements = (uint32_t)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--intervalle") == 0 && valeur)
+            charge.intervalleNs = atof(argv[++i]) * 1e6;
+        else if (strcmp(argv[i], "--threads") == 0 && valeur)
+            nbThreads = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "--graine") == 0 || strcmp(argv[i], "--seed") == 0) && valeur)
+            charge.graine = strtoull(argv[++i], NULL, 10);
+        else
+        {
+            fprintf(stderr, "Utilisation : %s [--socket CHEMIN] [--sessions N] [--mouvements M] [--intervalle MS] "
+                            "[--threads K] [--graine G]\n",
+                    argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (nbSessions < 1 || nbThreads < 1 || charge.intervalleNs < 0)
+    {
+        fprintf(stderr, "Il faut au moins 1 session et 1 thread.\n");
+        return EXIT_FAILURE;
+    }
+    if (nbThreads > nbSessions)
+    {
+        nbThreads = nbSessions;
+    }
+    augmenterDescripteurs();
+
+    // Chaque thread a ses sessions et sa place pour leurs latences
+    uint64_t nbMouvementsTotal = (uint64_t)nbSessions * charge.nbMouvements;
+    Injecteur *injecteurs = calloc(nbThreads, sizeof(Injecteur));
+    Joueur *joueurs = calloc(nbSessions, sizeof(Joueur));
+    uint32_t *latences = malloc((nbMouvementsTotal > 0 ? nbMouvementsTotal : 1) * sizeof(uint32_t));
+    if (injecteurs == NULL || joueurs == NULL || latences == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour les sessions");
+        return EXIT_FAILURE;
+    }
+    double debut = labyrinthe_clock();
+    int premier = 0;
+    for (int t = 0; t < nbThreads; t++)
+    {
+        Injecteur *injecteur = &injecteurs[t];
+        injecteur->charge = &charge;
+        injecteur->premier = premier;
+        injecteur->nbJoueurs = nbSessions / nbThreads + (t < nbSessions % nbThreads);
+        injecteur->joueurs = joueurs + premier;
+        injecteur->latences = latences + (uint64_t)premier * charge.nbMouvements;
+        premier += injecteur->nbJoueurs;
+        if (pthread_create(&injecteur->thread, NULL, injecter, injecteur) != 0)
+        {
+            perror("Erreur de création d'un thread");
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Les latences de chaque thread sont rassemblées au début du tableau, puis triées
+    uint64_t nbLatences = 0, retards = 0;
+    bool erreur = false;
+    for (int t = 0; t < nbThreads; t++)
+    {
+        pthread_join(injecteurs[t].thread, NULL);
+        memmove(latences + nbLatences, injecteurs[t].latences, injecteurs[t].nbLatences * sizeof(uint32_t));
+        nbLatences += injecteurs[t].nbLatences;
+        retards += injecteurs[t].retards;
+        erreur = erreur || injecteurs[t].erreur;
+    }
+    double duree = (labyrinthe_clock() - debut) / 1e9;
+    if (nbLatences == 0)
+    {
+        fprintf(stderr, "Aucune reponse du serveur\n");
+        return EXIT_FAILURE;
+    }
+    qsort(latences, nbLatences, sizeof(uint32_t), comparerLatences);
+    double p50 = latences[nbLatences / 2] / 1e3;
+    double p99 = latences[nbLatences * 99 / 100] / 1e3;
+    double p999 = latences[nbLatences * 999 / 1000] / 1e3;
+    double max = latences[nbLatences - 1] / 1e3;
+
+    printf("%d session(s), %llu mouvement(s) en %.2f s (%.0f par seconde), un mouvement toutes les %.0f ms par session\n",
+           nbSessions, (unsigned long long)nbLatences, duree, nbLatences / duree, charge.intervalleNs / 1e6);
+    printf("Latence : mediane %.1f us, p99 %.1f us, p99.9 %.1f us, max %.1f us ; %llu mouvement(s) en retard\n", p50,
+           p99, p999, max, (unsigned long long)retards);
+    printf("{\"fonction\":\"charge\",\"sessions\":%d,\"mouvements\":%llu,\"intervalle_ms\":%.1f,\"duree_s\":%.3f,"
+           "\"p50_us\":%.1f,\"p99_us\":%.1f,\"p999_us\":%.1f,\"max_us\":%.1f,\"retards\":%llu}\n",
+           nbSessions, (unsigned long long)nbLatences, charge.intervalleNs / 1e6, duree, p50, p99, p999, max,
+           (unsigned long long)retards);
+
+    free(latences);
+    free(joueurs);
+    free(injecteurs);
+    return erreur ? EXIT_FAILURE : 0;
+}
@@ -0,0 +1,599 @@
+/**
+ * @file labyrinthe.c
+ * @brief Moteur du jeu du labyrinthe, sans affichage ni clavier
+ *
+ * Ce fichier implémente l'interface de labyrinthe.h avec les fonctions de toolBox.c : le labyrinthe est
+ * un arbre compact, la partie une Partie (voir jouerPartie). Aucune fonction ne lit le clavier
+ * ni n'écrit sur la console ; les messages des événements ne sont composés que sur demande.
+ * Le labyrinthe n'est jamais modifié par les parties : plusieurs parties, sur des threads différents, le lisent
+ * sans verrou, et chacune ne possède que ses visites, sa position et sa clé (voir Visites).
+ *
+ * Les fonctions principales incluent :
+ * - labyrinthe_new / labyrinthe_open : Génère un labyrinthe, ou rouvre un labyrinthe sauvegardé, et commence la partie.
+ * - labyrinthe_join : Commence une autre partie sur le même labyrinthe, sans le recopier.
+ * - labyrinthe_step : Joue un mouvement.
+ * - labyrinthe_position, labyrinthe_neighbor, labyrinthe_room... : Lisent l'état de la partie.
+ * - labyrinthe_save / labyrinthe_replay : Sauvegarde le labyrinthe et le journal de la partie, puis la rejoue.
+ * - labyrinthe_export / labyrinthe_generate_file : Exporte un labyrinthe, ou en génère un directement dans un fichier.
+ * - labyrinthe_stats_* : Relevés des temps et compteurs du moteur et de la boucle de jeu du client (--stats).
+ *
+ * @note Utilisation du compilateur GCC.
+ */
+
+#include "toolBox.c"
+#include "labyrinthe.h"
+
+typedef struct Topologie // Labyrinthe partagé par plusieurs parties, libéré avec la dernière
+{
+    ArbreCompact *arbre;    // Forme et événements, en lecture seule une fois la génération finie
+    atomic_uint references; // Nombre de parties sur ce labyrinthe
+} Topologie;
+
+struct Labyrinthe
+{
+    const ArbreCompact *arbre; // Forme et événements, jamais modifiés par la partie
+    Topologie *topologie;      // Labyrinthe partagé, pour sa libération
+    Partie partie;       // État de la partie
+    uint64_t graine;     // Graine de la partie, pour les mouvements aléatoires de la salle A
+    int mode;            // Options (LABYRINTHE_MESSAGES, LABYRINTHE_JOURNAL...)
+    Tampon messages;     // Messages du dernier mouvement, avec LABYRINTHE_MESSAGES
+    Journal journal;     // Mouvements de la partie, avec LABYRINTHE_JOURNAL
+};
+
+/**
+ * Début d'une partie sur un labyrinthe partagé, dont la partie prend une référence.
+ * @param topologie Le labyrinthe.
+ * @param graine La graine de la partie.
+ * @param mode Les options (LABYRINTHE_MESSAGES, LABYRINTHE_JOURNAL).
+ * @return la nouvelle partie.
+ */
+static Labyrinthe *rejoindreTopologie(Topologie *topologie, uint64_t graine, int mode)
+{
+    Labyrinthe *labyrinthe = calloc(1, sizeof(Labyrinthe));
+    if (labyrinthe == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour le labyrinthe");
+        exit(EXIT_FAILURE);
+    }
+    atomic_fetch_add_explicit(&topologie->references, 1, memory_order_relaxed);
+    labyrinthe->topologie = topologie;
+    labyrinthe->arbre = topologie->arbre;
+    labyrinthe->mode = mode;
+    initPartie(&labyrinthe->partie, topologie->arbre, graine);
+    if (mode & LABYRINTHE_MESSAGES)
+    {
+        labyrinthe->partie.image = &labyrinthe->messages;
+    }
+    labyrinthe_reset(labyrinthe, graine);
+    return labyrinthe;
+}
+
+/**
+ * Début de la première partie sur un labyrinthe qui vient d'être créé.
+ * @param arbre Le labyrinthe, libéré avec la dernière partie.
+ * @param graine La graine de la partie.
+ * @param mode Les options (LABYRINTHE_MESSAGES, LABYRINTHE_JOURNAL).
+ * @return la nouvelle partie.
+ */
+static Labyrinthe *commencerLabyrinthe(ArbreCompact *arbre, uint64_t graine, int mode)
+{
+    Topologie *topologie = malloc(sizeof(Topologie));
+    if (topologie == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour le labyrinthe");
+        exit(EXIT_FAILURE);
+    }
+    topologie->arbre = arbre;
+    atomic_init(&topologie->references, 0);
+    return rejoindreTopologie(topologie, graine, mode);
+}
+
+/**
+ * Génération d'un labyrinthe qui a une solution, et début de la partie à l'entrée.
+ * @param seed La graine : la même graine donne le même labyrinthe et la même partie.
+ * @param size Le nombre de salles, entre 2 et 2^31 - 1 (50 au plus avec LABYRINTHE_DESCENTE, 2^30 - 1 sans
+ * LABYRINTHE_PARALLELE : la génération linéaire construit l'arbre d'un seul bloc).
+ * @param mode Les options (LABYRINTHE_EVENEMENTS, LABYRINTHE_MESSAGES...), 0 pour le mode mini.
+ * @return la partie, NULL si la taille n'est pas possible.
+ */
+Labyrinthe *labyrinthe_new(uint64_t seed, uint32_t size, int mode)
+{
+    if (size < 2 || size > INT32_MAX || ((mode & LABYRINTHE_DESCENTE) && size > 50) ||
+        (!(mode & (LABYRINTHE_DESCENTE | LABYRINTHE_PARALLELE)) && size > TAILLE_MAX_REMY))
+    {
+        return NULL;
+    }
+    AlgorithmeGeneration algorithme = mode & LABYRINTHE_PARALLELE  ? GENERATION_PARALLELE
+                                      : mode & LABYRINTHE_DESCENTE ? GENERATION_DESCENTE
+                                                                   : GENERATION_LINEAIRE;
+    Alea alea;
+    aleaInit(&alea, seed);
+    ArbreCompact *arbre;
+    if (mode & LABYRINTHE_EVENEMENTS)
+    {
+        arbre = genererLabyrintheCompact((int)size, algorithme, &alea);
+    }
+    else if (algorithme == GENERATION_DESCENTE)
+    {
+        // Mode mini : seulement l'entrée et la sortie, toujours atteignable
+        Arbre *arbreMini = init();
+        genererArbre(arbreMini, (int)size, &alea);
+        arbreMini->current = arbreMini->premier;
+        arbre = compacterArbre(arbreMini);
+        detruireArbre(arbreMini);
+    }
+    else
+    {
+        arbre = algorithme == GENERATION_PARALLELE ? genererArbreCompactParallele(size, nombreCoeurs(), &alea, NULL)
+                                                   : genererArbreCompact(size, &alea);
+    }
+    return commencerLabyrinthe(arbre, aleaSuivant(&alea), mode);
+}
+
+/**
+ * Ouverture d'un labyrinthe sauvegardé (voir sauvegarderLabyrinthe), et début de la partie à l'entrée.
+ * @param path Le chemin du fichier.
+ * @param seed La graine de la partie.
+ * @param mode Les options (LABYRINTHE_MESSAGES, LABYRINTHE_JOURNAL).
+ * @return la partie, NULL si le fichier n'est pas un labyrinthe valide.
+ */
+Labyrinthe *labyrinthe_open(const char *path, uint64_t seed, int mode)
+{
+    ArbreCompact *arbre = ouvrirLabyrinthe(path);
+    return arbre != NULL ? commencerLabyrinthe(arbre, seed, mode) : NULL;
+}
+
+/**
+ * Nouvelle partie sur le labyrinthe d'une autre partie, à l'entrée. Le labyrinthe n'est pas recopié : la partie
+ * n'alloue que ses visites, quelques centaines d'octets tant qu'elle a peu exploré. Les deux parties peuvent
+ * ensuite être jouées et libérées sur des threads différents, dans n'importe quel ordre.
+ * @param model Une partie sur le labyrinthe à partager.
+ * @param seed La graine de la nouvelle partie.
+ * @param mode Les options (LABYRINTHE_MESSAGES, LABYRINTHE_JOURNAL) ; celles de génération sont sans effet.
+ * @return la nouvelle partie.
+ */
+Labyrinthe *labyrinthe_join(const Labyrinthe *model, uint64_t seed, int mode)
+{
+    return rejoindreTopologie(model->topologie, seed, mode);
+}
+
+/**
+ * Libération d'une partie, et de son labyrinthe si c'était la dernière partie dessus.
+ * @param labyrinthe La partie, NULL accepté.
+ */
+void labyrinthe_free(Labyrinthe *labyrinthe)
+{
+    if (labyrinthe == NULL)
+    {
+        return;
+    }
+    libererPartie(&labyrinthe->partie);
+    libererJournal(&labyrinthe->journal);
+    tamponLiberer(&labyrinthe->messages);
+    if (atomic_fetch_sub_explicit(&labyrinthe->topologie->references, 1, memory_order_acq_rel) == 1)
+    {
+        detruireArbreCompact(labyrinthe->topologie->arbre);
+        free(labyrinthe->topologie);
+    }
+    free(labyrinthe);
+}
+
+/**
+ * Retour au début de la partie, sur le même labyrinthe, sans nouvelle allocation.
+ * @param labyrinthe La partie.
+ * @param seed La nouvelle graine de la partie.
+ */
+void labyrinthe_reset(Labyrinthe *labyrinthe, uint64_t seed)
+{
+    labyrinthe->graine = seed;
+    labyrinthe->messages.taille = 0;
+    recommencerPartie(&labyrinthe->partie, seed);
+    if (labyrinthe->mode & LABYRINTHE_JOURNAL)
+    {
+        journalCommencer(&labyrinthe->journal, seed);
+    }
+}
+
+/**
+ * Un mouvement du joueur, avec les règles de jouerPartie.
+ * @param labyrinthe La partie.
+ * @param move Le mouvement demandé ; après la salle A, n'importe quel mouvement est tiré au hasard.
+ * @return LABYRINTHE_GAGNE si le joueur atteint la sortie, LABYRINTHE_DEPLACE s'il change de salle,
+ * LABYRINTHE_IMMOBILE sinon.
+ */
+ResultatPas labyrinthe_step(Labyrinthe *labyrinthe, MouvementLabyrinthe move)
+{
+    static const Touche touches[] = {TOUCHE_HAUT, TOUCHE_GAUCHE, TOUCHE_DROITE};
+    if ((unsigned)move > LABYRINTHE_DROITE)
+    {
+        return LABYRINTHE_IMMOBILE;
+    }
+    labyrinthe->messages.taille = 0; // Seuls les messages de ce mouvement sont gardés
+    bool deplace = labyrinthe->mode & LABYRINTHE_JOURNAL
+                       ? jouerPartieJournal(&labyrinthe->partie, touches[move], &labyrinthe->journal)
+                       : jouerPartie(&labyrinthe->partie, touches[move]);
+    if (!deplace)
+    {
+        return LABYRINTHE_IMMOBILE;
+    }
+    return labyrinthe->partie.gagnee ? LABYRINTHE_GAGNE : LABYRINTHE_DEPLACE;
+}
+
+/**
+ * Sauvegarde du labyrinthe et du journal de la partie, pour la rejouer (voir rejouerJournal).
+ * @param labyrinthe La partie.
+ * @param pathLabyrinthe Le fichier du labyrinthe, NULL pour ne pas l'écrire.
+ * @param pathJournal Le fichier du journal, NULL pour ne pas l'écrire (il faut LABYRINTHE_JOURNAL).
+ * @return true si tous les fichiers demandés ont été écrits.
+ */
+bool labyrinthe_save(Labyrinthe *labyrinthe, const char *pathLabyrinthe, const char *pathJournal)
+{
+    if (pathLabyrinthe != NULL && !sauvegarderLabyrinthe(labyrinthe->arbre, pathLabyrinthe))
+    {
+        return false;
+    }
+    if (pathJournal != NULL)
+    {
+        if (!(labyrinthe->mode & LABYRINTHE_JOURNAL))
+        {
+            return false;
+        }
+        terminerJournal(&labyrinthe->journal, &labyrinthe->partie);
+        return sauvegarderJournal(&labyrinthe->journal, pathJournal);
+    }
+    return true;
+}
+
+/**
+ * Rejoue sans affichage la partie d'un journal (voir rejouerJournal) sur ce labyrinthe.
+ * La partie recommence avec la graine du journal et finit dans l'état rejoué.
+ * @param labyrinthe La partie, sur le labyrinthe de la partie journalisée.
+ * @param pathJournal Le fichier du journal.
+ * @param identical Vrai en sortie si la partie rejouée suit le journal et finit dans le même état.
+ * @return false si le journal n'a pas pu être lu.
+ */
+bool labyrinthe_replay(Labyrinthe *labyrinthe, const char *pathJournal, bool *identical)
+{
+    Journal journal = {0};
+    if (!chargerJournal(&journal, pathJournal))
+    {
+        libererJournal(&journal);
+        return false;
+    }
+    labyrinthe->graine = journal.graine;
+    labyrinthe->messages.taille = 0;
+    *identical = rejouerJournal(&labyrinthe->partie, &journal);
+    libererJournal(&journal);
+    return true;
+}
+
+/**
+ * Export du labyrinthe pour les outils externes (voir exporterArbreCompact).
+ * @param labyrinthe La partie.
+ * @param format Le format d'export.
+ * @param stream Le flux où écrire, ouvert en binaire.
+ * @return true si tout a été écrit.
+ */
+bool labyrinthe_export(const Labyrinthe *labyrinthe, ExportLabyrinthe format, FILE *stream)
+{
+    return exporterArbreCompact(labyrinthe->arbre, format == LABYRINTHE_DOT ? EXPORT_DOT : EXPORT_JSON, stream);
+}
+
+/**
+ * Génération d'un labyrinthe qui a une solution directement dans un fichier, sans partie
+ * (voir genererLabyrintheFichier) : la taille n'est limitée que par le disque.
+ * @param seed La graine : la même graine donne le même fichier.
+ * @param size Le nombre de salles, au moins 2.
+ * @param path Le chemin du fichier, remplacé s'il existe.
+ * @return true si le fichier a été écrit.
+ */
+bool labyrinthe_generate_file(uint64_t seed, uint32_t size, const char *path)
+{
+    if (size < 2 || size >= AUCUN_NOEUD)
+    {
+        return false;
+    }
+    Alea alea;
+    aleaInit(&alea, seed);
+    return genererLabyrintheFichier(size, path, &alea);
+}
+
+/**
+ * Nombre de salles du labyrinthe.
+ * @param labyrinthe La partie.
+ * @return le nombre de salles.
+ */
+uint32_t labyrinthe_size(const Labyrinthe *labyrinthe)
+{
+    return labyrinthe->arbre->taille;
+}
+
+/**
+ * Graine de la partie.
+ * @param labyrinthe La partie.
+ * @return la graine donnée à labyrinthe_open ou labyrinthe_reset, ou tirée par labyrinthe_new.
+ */
+uint64_t labyrinthe_seed(const Labyrinthe *labyrinthe)
+{
+    return labyrinthe->graine;
+}
+
+/**
+ * Salle où se trouve le joueur.
+ * @param labyrinthe La partie.
+ * @return l'indice de la salle.
+ */
+uint32_t labyrinthe_position(const Labyrinthe *labyrinthe)
+{
+    return labyrinthe->partie.current;
+}
+
+/**
+ * Salle voisine d'une salle.
+ * @param labyrinthe La partie.
+ * @param room L'indice de la salle.
+ * @param direction La direction.
+ * @return l'indice de la salle voisine, LABYRINTHE_AUCUNE_SALLE s'il n'y en a pas.
+ */
+uint32_t labyrinthe_neighbor(const Labyrinthe *labyrinthe, uint32_t room, MouvementLabyrinthe direction)
+{
+    const ArbreCompact *arbre = labyrinthe->arbre;
+    if (room >= arbre->taille)
+    {
+        return LABYRINTHE_AUCUNE_SALLE;
+    }
+    switch (direction)
+    {
+    case LABYRINTHE_HAUT:
+        return parentCompact(arbre, room);
+    case LABYRINTHE_GAUCHE:
+        return gaucheCompact(arbre, room);
+    case LABYRINTHE_DROITE:
+        return droiteCompact(arbre, room);
+    }
+    return LABYRINTHE_AUCUNE_SALLE;
+}
+
+/**
+ * Salle telle que la voit le joueur : son événement si elle a été visitée, '?' sinon.
+ * @param labyrinthe La partie.
+ * @param room L'indice de la salle.
+ * @return la lettre de la salle, '?' si elle n'a pas été visitée, 0 si elle n'existe pas.
+ */
+char labyrinthe_room(const Labyrinthe *labyrinthe, uint32_t room)
+{
+    if (room >= labyrinthe->arbre->taille)
+    {
+        return 0;
+    }
+    return estVisitePartie(&labyrinthe->partie, room) ? labyrinthe->arbre->events[room] : '?';
+}
+
+/**
+ * Événement d'une salle, qu'elle ait été visitée ou non (affichage debug, agents de la simulation).
+ * @param labyrinthe La partie.
+ * @param room L'indice de la salle.
+ * @return la lettre de l'événement, 0 si la salle n'existe pas.
+ */
+char labyrinthe_event(const Labyrinthe *labyrinthe, uint32_t room)
+{
+    return room < labyrinthe->arbre->taille ? labyrinthe->arbre->events[room] : 0;
+}
+
+/**
+ * Possession de la clé.
+ * @param labyrinthe La partie.
+ * @return vrai si le joueur a trouvé la clé.
+ */
+bool labyrinthe_has_key(const Labyrinthe *labyrinthe)
+{
+    return labyrinthe->partie.cleTrouvee;
+}
+
+/**
+ * Mouvement aléatoire à venir (salle A).
+ * @param labyrinthe La partie.
+ * @return vrai si le prochain mouvement sera tiré au hasard.
+ */
+bool labyrinthe_random_next(const Labyrinthe *labyrinthe)
+{
+    return labyrinthe->partie.randomMove;
+}
+
+/**
+ * Fin de la partie.
+ * @param labyrinthe La partie.
+ * @return vrai si le joueur a atteint la sortie.
+ */
+bool labyrinthe_won(const Labyrinthe *labyrinthe)
+{
+    return labyrinthe->partie.gagnee;
+}
+
+/**
+ * Nombre de déplacements depuis le début de la partie.
+ * @param labyrinthe La partie.
+ * @return le nombre de déplacements.
+ */
+uint32_t labyrinthe_moves(const Labyrinthe *labyrinthe)
+{
+    return labyrinthe->partie.nbMouvements;
+}
+
+/**
+ * Nombre de salles que le joueur n'a pas visitées (ou a oubliées).
+ * @param labyrinthe La partie.
+ * @return le nombre de salles non explorées.
+ */
+uint32_t labyrinthe_unexplored(const Labyrinthe *labyrinthe)
+{
+    return labyrinthe->partie.nbNonExplores;
+}
+
+/**
+ * Nombre de chutes (salle U) depuis le début de la partie.
+ * @param labyrinthe La partie.
+ * @return le nombre de retours à l'entrée.
+ */
+uint32_t labyrinthe_falls(const Labyrinthe *labyrinthe)
+{
+    return labyrinthe->partie.nbChutes;
+}
+
+/**
+ * Nombre de pertes de mémoire (salle R) depuis le début de la partie.
+ * @param labyrinthe La partie.
+ * @return le nombre d'oublis des visites.
+ */
+uint32_t labyrinthe_forgets(const Labyrinthe *labyrinthe)
+{
+    return labyrinthe->partie.nbOublis;
+}
+
+/**
+ * Messages des événements déclenchés par le dernier mouvement, avec LABYRINTHE_MESSAGES.
+ * @param labyrinthe La partie.
+ * @return le texte des messages, vide s'il n'y en a pas ; valable jusqu'au prochain mouvement.
+ */
+const char *labyrinthe_message(const Labyrinthe *labyrinthe)
+{
+    return labyrinthe->messages.taille > 0 ? labyrinthe->messages.donnees : "";
+}
+
+/**
+ * Plus court parcours de l'entrée jusqu'à la sortie (voir resoudreLabyrintheCompact).
+ * @param labyrinthe La partie ; seul le labyrinthe compte, pas la progression du joueur.
+ * @param reason Pourquoi il n'y a pas de solution, en sortie ; NULL accepté.
+ * @return le nombre de mouvements du parcours, -1 s'il n'y en a pas.
+ */
+int labyrinthe_solve(const Labyrinthe *labyrinthe, const char **reason)
+{
+    Solution solution = resoudreLabyrintheCompact(labyrinthe->arbre);
+    int nbMouvements = solution.existe ? solution.nbMouvements : -1;
+    if (reason != NULL)
+    {
+        *reason = solution.raison;
+    }
+    libererSolution(&solution);
+    return nbMouvements;
+}
+
+/**
+ * Type d'événement, pour présenter les règles du jeu.
+ * @param index L'indice du type, à partir de 0.
+ * @param letter La lettre des salles de ce type, en sortie.
+ * @return la description du type, NULL après le dernier.
+ */
+const char *labyrinthe_event_type(uint32_t index, char *letter)
+{
+    if (index >= NB_TYPES_EVENTS)
+    {
+        return NULL;
+    }
+    *letter = eventTypes[index].letter;
+    return eventTypes[index].description;
+}
+
+/**
+ * Tirage pseudo-aléatoire reproductible (splitmix64), pour tirer les graines des parties.
+ * @param state L'état du générateur, une graine au départ, mis à jour.
+ * @return 64 bits pseudo-aléatoires.
+ */
+uint64_t labyrinthe_random(uint64_t *state)
+{
+    return splitmix64(state);
+}
+
+/**
+ * Instant actuel en nanosecondes, pour mesurer des durées.
+ * @return le temps écoulé depuis une origine fixe.
+ */
+double labyrinthe_clock(void)
+{
+    return maintenantNs();
+}
+
+/**
+ * Nombre de cœurs de la machine, pour dimensionner les threads des clients.
+ * @return le nombre de processeurs en ligne, au moins 1.
+ */
+int labyrinthe_threads(void)
+{
+    return nombreCoeurs();
+}
+
+/**
+ * Début des relevés de la session : temps de génération, compteurs du moteur et tours de jeu.
+ * Les relevés ne sont faits que depuis le thread qui les a activés.
+ */
+void labyrinthe_stats_enable(void)
+{
+    releves.actives = true;
+}
+
+/**
+ * Début d'une mesure de temps de la boucle de jeu.
+ * @return l'instant actuel, 0 sans relevés (sans lire l'horloge).
+ */
+double labyrinthe_stats_start(void)
+{
+    return debutChrono();
+}
+
+/**
+ * Fin d'une mesure de temps de la boucle de jeu.
+ * @param mesure Le temps mesuré.
+ * @param startNs L'instant donné par labyrinthe_stats_start.
+ */
+void labyrinthe_stats_stop(MesureLabyrinthe mesure, double startNs)
+{
+    finChrono((Chrono)(CHRONO_ATTENTE + mesure), startNs);
+}
+
+/**
+ * Un tour de boucle de jeu.
+ * @param keys Le nombre de touches lues pendant ce tour.
+ */
+void labyrinthe_stats_turn(int keys)
+{
+    if (releves.actives)
+    {
+        releves.tours++;
+        releves.touches += keys;
+    }
+}
+
+/**
+ * Une image écrite sur le terminal.
+ * @param bytes Le nombre d'octets écrits.
+ */
+void labyrinthe_stats_frame(size_t bytes)
+{
+    if (releves.actives)
+    {
+        releves.images++;
+        releves.octetsEcrits += bytes;
+        if (bytes > releves.octetsMax)
+        {
+            releves.octetsMax = bytes;
+        }
+    }
+}
+
+/**
+ * Résumé lisible des relevés de la session (voir afficherReleves).
+ * @param stream Le flux où écrire le résumé.
+ */
+void labyrinthe_stats_print(FILE *stream)
+{
+    afficherReleves(stream);
+}
+
+/**
+ * Relevés de la session sur une ligne JSON (voir exporterReleves).
+ * @param stream Le flux où écrire la ligne.
+ */
+void labyrinthe_stats_json(FILE *stream)
+{
+    exporterReleves(stream);
+}
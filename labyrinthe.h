@@ -0,0 +1,117 @@
+/**
+ * @file labyrinthe.h
+ * @brief Moteur du jeu du labyrinthe, sans affichage ni clavier
+ *
+ * Cette interface permet de créer un labyrinthe, d'y jouer mouvement par mouvement et d'interroger
+ * l'état de la partie sans console : pour embarquer le jeu dans des simulateurs ou des tests de charge,
+ * où l'affichage coûterait plus cher que les règles elles-mêmes.
+ * Elle est compilée dans la bibliothèque labyrinthe (labyrinthe.c, avec le moteur toolBox.c) ; le menu (main.c),
+ * la simulation, le serveur et son client de charge n'incluent que cet en-tête et sont liés à la bibliothèque.
+ * Le menu n'y ajoute que l'affichage et le clavier (affichage.c) : toutes ses parties sont jouées avec labyrinthe_step.
+ *
+ * Les structures principales incluent :
+ * - Labyrinthe : Un labyrinthe et la partie qui s'y joue, opaque.
+ * - MouvementLabyrinthe : Mouvement demandé par le joueur.
+ * - ResultatPas : Résultat d'un mouvement.
+ * - ExportLabyrinthe : Format d'export d'un labyrinthe.
+ * - MesureLabyrinthe : Temps d'un tour de jeu relevé par le client (labyrinthe_stats_stop).
+ *
+ * Plusieurs parties peuvent partager un même labyrinthe (labyrinthe_join) : il n'est alors stocké qu'une fois,
+ * lu sans verrou, et chaque partie n'a en propre que ses visites, sa position et sa clé.
+ *
+ * Les salles sont désignées par leur indice dans le labyrinthe, l'entrée étant la salle 0.
+ * Les relevés (labyrinthe_stats_*) ne sont faits que sur demande, et depuis un seul thread.
+ *
+ * @note Utilisation du compilateur GCC.
+ */
+
+#ifndef LABYRINTHE_H
+#define LABYRINTHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+typedef struct Labyrinthe Labyrinthe; // Partie en cours et son labyrinthe, à créer avec labyrinthe_new, _open ou _join
+
+// Options de labyrinthe_new et labyrinthe_open, à combiner ; 0 donne le mode mini (sans événement, sans message)
+#define LABYRINTHE_EVENEMENTS 1 // Place les événements (clé, porte, chute...) ; sans effet sur un labyrinthe ouvert
+#define LABYRINTHE_MESSAGES 2   // Compose les messages des événements, lus avec labyrinthe_message
+#define LABYRINTHE_JOURNAL 4    // Garde le journal des mouvements, écrit avec labyrinthe_save
+#define LABYRINTHE_PARALLELE 8  // Génère la forme et les événements sur tous les cœurs (très grands labyrinthes)
+#define LABYRINTHE_DESCENTE 16  // Génère la forme en redescendant depuis la racine pour chaque nœud (petits labyrinthes)
+
+#define LABYRINTHE_AUCUNE_SALLE UINT32_MAX // Salle inexistante (voisin absent)
+
+typedef enum MouvementLabyrinthe // Mouvement demandé ; après la salle A, le mouvement est tiré au hasard
+{
+    LABYRINTHE_HAUT,   // Vers le parent
+    LABYRINTHE_GAUCHE, // Vers le fils gauche
+    LABYRINTHE_DROITE  // Vers le fils droit
+} MouvementLabyrinthe;
+
+typedef enum ResultatPas // Résultat d'un mouvement
+{
+    LABYRINTHE_IMMOBILE, // Pas de salle dans cette direction, porte fermée, ou partie déjà gagnée
+    LABYRINTHE_DEPLACE,  // Le joueur a changé de salle
+    LABYRINTHE_GAGNE     // Le joueur a atteint la sortie
+} ResultatPas;
+
+typedef enum ExportLabyrinthe // Format de labyrinthe_export
+{
+    LABYRINTHE_DOT, // Graphe GraphViz : un nœud et une arête par salle
+    LABYRINTHE_JSON // JSON lines : un objet par salle et par ligne
+} ExportLabyrinthe;
+
+typedef enum MesureLabyrinthe // Temps d'un tour de boucle de jeu, mesuré par le client
+{
+    LABYRINTHE_ATTENTE,  // Attente des touches
+    LABYRINTHE_LOGIQUE,  // Application des touches lues
+    LABYRINTHE_AFFICHAGE // Composition et écriture de l'image
+} MesureLabyrinthe;
+
+Labyrinthe *labyrinthe_new(uint64_t seed, uint32_t size, int mode);
+Labyrinthe *labyrinthe_open(const char *path, uint64_t seed, int mode);
+Labyrinthe *labyrinthe_join(const Labyrinthe *model, uint64_t seed, int mode);
+void labyrinthe_free(Labyrinthe *labyrinthe);
+void labyrinthe_reset(Labyrinthe *labyrinthe, uint64_t seed);
+ResultatPas labyrinthe_step(Labyrinthe *labyrinthe, MouvementLabyrinthe move);
+bool labyrinthe_save(Labyrinthe *labyrinthe, const char *pathLabyrinthe, const char *pathJournal);
+bool labyrinthe_replay(Labyrinthe *labyrinthe, const char *pathJournal, bool *identical);
+bool labyrinthe_export(const Labyrinthe *labyrinthe, ExportLabyrinthe format, FILE *stream);
+bool labyrinthe_generate_file(uint64_t seed, uint32_t size, const char *path);
+
+// Lectures de l'état, sans effet sur la partie
+uint32_t labyrinthe_size(const Labyrinthe *labyrinthe);
+uint64_t labyrinthe_seed(const Labyrinthe *labyrinthe);
+uint32_t labyrinthe_position(const Labyrinthe *labyrinthe);
+uint32_t labyrinthe_neighbor(const Labyrinthe *labyrinthe, uint32_t room, MouvementLabyrinthe direction);
+char labyrinthe_room(const Labyrinthe *labyrinthe, uint32_t room);
+char labyrinthe_event(const Labyrinthe *labyrinthe, uint32_t room);
+bool labyrinthe_has_key(const Labyrinthe *labyrinthe);
+bool labyrinthe_random_next(const Labyrinthe *labyrinthe);
+bool labyrinthe_won(const Labyrinthe *labyrinthe);
+uint32_t labyrinthe_moves(const Labyrinthe *labyrinthe);
+uint32_t labyrinthe_unexplored(const Labyrinthe *labyrinthe);
+uint32_t labyrinthe_falls(const Labyrinthe *labyrinthe);
+uint32_t labyrinthe_forgets(const Labyrinthe *labyrinthe);
+const char *labyrinthe_message(const Labyrinthe *labyrinthe);
+int labyrinthe_solve(const Labyrinthe *labyrinthe, const char **reason);
+
+// Règles et outils communs aux programmes, sans partie
+const char *labyrinthe_event_type(uint32_t index, char *letter);
+uint64_t labyrinthe_random(uint64_t *state);
+double labyrinthe_clock(void);
+int labyrinthe_threads(void);
+
+// Relevés des temps et compteurs de la session, résumés avec labyrinthe_stats_print
+void labyrinthe_stats_enable(void);
+double labyrinthe_stats_start(void);
+void labyrinthe_stats_stop(MesureLabyrinthe mesure, double startNs);
+void labyrinthe_stats_turn(int keys);
+void labyrinthe_stats_frame(size_t bytes);
+void labyrinthe_stats_print(FILE *stream);
+void labyrinthe_stats_json(FILE *stream);
+
+#endif // LABYRINTHE_H
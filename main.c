@@ -7,11 +7,20 @@
  * un mode normal avec des événements, et un mode debug avec des événements et un affichage détaillé.
  *
  * Les touches de direction sont utilisées pour naviguer dans l'arbre, et la touche Echap permet de quitter le jeu.
+ * L'option --seed N (ou --graine N) fixe la graine du générateur : la même graine donne les mêmes labyrinthes
+ * sur toutes les machines, pour rejouer une partie ou reproduire un problème.
+ * L'option --stats relève les temps de génération et de chaque tour de jeu (attente, logique, affichage),
+ * le travail sur les visites (oublis, octets effacés, mises à jour des nœuds non explorés), les octets écrits
+ * et les événements déclenchés ; ils sont affichés en quittant et écrits sur une ligne JSON dans labyrinthe_stats.json.
+ * Chaque partie est aussi enregistrée (labyrinthe et journal des mouvements) dans derniere_partie.laby
+ * et derniere_partie.journal : le menu permet de la rejouer sans affichage et de vérifier qu'elle finit à l'identique.
  *
  * Différents fichiers sont utilisés pour organiser le code :
- * - main.c : le point d'entrée du programme
- * - toolBox.h : les déclarations des fonctions et des structures de données
- * - toolBox.c : les définitions des fonctions
+ * - main.c : le point d'entrée du programme, le menu et les boucles de jeu
+ * - affichage.h / affichage.c : l'affichage sur le terminal et la lecture du clavier
+ * - labyrinthe.h : l'interface du moteur du jeu, la seule que voit le menu ; toutes les parties sont jouées
+ *   avec labyrinthe_step
+ * - labyrinthe.c, toolBox.h / toolBox.c, tampon.h / tampon.c : le moteur, compilé dans la bibliothèque labyrinthe
  *
  * Les événements incluent :
  * - 'E' : Entrée du labyrinthe
@@ -28,17 +37,278 @@
  * @note Utilisation du compilateur GCC.
  */
 
-#include "toolBox.c"
-#include <conio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
-void main(void)
+#include "affichage.h"
+#include "labyrinthe.h"
+
+// Algorithmes de génération de l'arbre, proposés par le menu pour les comparer
+typedef enum AlgorithmeMenu
+{
+    ALGORITHME_DESCENTE,  // Descente depuis la racine, O(n * profondeur)
+    ALGORITHME_LINEAIRE,  // Génération linéaire, directement en représentation compacte
+    ALGORITHME_PARALLELE  // Génération sur tous les cœurs
+} AlgorithmeMenu;
+
+/**
+ * Taille maximale de l'arbre selon l'algorithme de génération.
+ * La descente depuis la racine coûte O(n * profondeur), les générations linéaire et parallèle permettent de très grands arbres.
+ * @param algorithme L'algorithme de génération.
+ * @return le nombre maximum de nœuds.
+ */
+int tailleMaximale(AlgorithmeMenu algorithme)
+{
+    return algorithme == ALGORITHME_DESCENTE ? 50 : 100000000;
+}
+
+/**
+ * Options de labyrinthe_new pour un algorithme de génération.
+ * @param algorithme L'algorithme de génération.
+ * @return LABYRINTHE_DESCENTE, LABYRINTHE_PARALLELE ou 0.
+ */
+int optionsAlgorithme(AlgorithmeMenu algorithme)
+{
+    return algorithme == ALGORITHME_PARALLELE  ? LABYRINTHE_PARALLELE
+           : algorithme == ALGORITHME_DESCENTE ? LABYRINTHE_DESCENTE
+                                               : 0;
+}
+
+// Fichiers où est enregistrée la dernière partie jouée
+#define FICHIER_PARTIE_LABYRINTHE "derniere_partie.laby"
+#define FICHIER_PARTIE_JOURNAL "derniere_partie.journal"
+
+// Fichier où sont écrites les statistiques de la session, avec --stats
+#define FICHIER_STATISTIQUES "labyrinthe_stats.json"
+
+/**
+ * Affichage et écriture des statistiques de la session, à la sortie du programme (option --stats).
+ */
+void terminerStatistiques()
+{
+    labyrinthe_stats_print(stdout);
+    FILE *fichier = fopen(FICHIER_STATISTIQUES, "w");
+    if (fichier == NULL)
+    {
+        perror("Erreur d'ouverture du fichier de statistiques");
+        return;
+    }
+    labyrinthe_stats_json(fichier);
+    fclose(fichier);
+    printf("Statistiques ecrites dans %s\n", FICHIER_STATISTIQUES);
+}
+
+/**
+ * Affichage de debug : le labyrinthe entier, les choix, le coût de l'image précédente et la solution.
+ * @param labyrinthe La partie.
+ * @param ecran L'écran, pour le nombre de lignes réécrites.
+ * @param latenceNs Le temps entre l'arrivée du dernier lot de touches et l'affichage de son image.
+ * @param solution Le nombre de mouvements du plus court parcours, -1 s'il n'y en a pas.
+ * @param raison Pourquoi il n'y a pas de solution.
+ * @param image Le tampon dans lequel composer l'affichage.
+ */
+void afficherDebug(const Labyrinthe *labyrinthe, const Ecran *ecran, double latenceNs, int solution,
+                   const char *raison, Tampon *image)
+{
+    uint32_t current = labyrinthe_position(labyrinthe);
+    afficherArbre(labyrinthe, 0, 0, image);
+    // on affiche les mouvements possibles
+    afficherChoix(labyrinthe_neighbor(labyrinthe, current, LABYRINTHE_GAUCHE) != LABYRINTHE_AUCUNE_SALLE,
+                  labyrinthe_neighbor(labyrinthe, current, LABYRINTHE_DROITE) != LABYRINTHE_AUCUNE_SALLE,
+                  labyrinthe_neighbor(labyrinthe, current, LABYRINTHE_HAUT) != LABYRINTHE_AUCUNE_SALLE, image);
+    // et la taille de l'image précédente
+    tamponAjouter(image, "Image precedente : %d lignes reecrites, %zu octets, affichee en %.1f us\n",
+                  ecran->lignesModifiees, image->derniereTaille, image->dernierTempsNs / 1000);
+    tamponAjouter(image, "Latence touche -> image precedente : %.1f us\n", latenceNs / 1000);
+    if (solution >= 0)
+    {
+        tamponAjouter(image, "Plus court parcours depuis l'entree : %d mouvements\n\n", solution);
+    }
+    else
+    {
+        tamponAjouter(image, "Pas de solution : %s\n\n", raison);
+    }
+}
+
+/**
+ * Boucle de jeu sur une partie du moteur (labyrinthe.h) : les règles sont celles de labyrinthe_step,
+ * cette boucle ne fait que lire le clavier et afficher la partie avec les messages des événements.
+ * @param labyrinthe La partie, créée avec LABYRINTHE_MESSAGES.
+ * @param debug Vrai pour afficher tout le labyrinthe et la solution (mode debug), la vue du joueur sinon.
+ */
+void boucleJeuLabyrinthe(Labyrinthe *labyrinthe, bool debug)
 {
-    // Seed pour les nombres aléatoires
-    srand(time(NULL));
+    bool fini = false;  // Sortie trouvée ou partie quittée
+    Tampon image = {0}; // Image composée à chaque tour, écrite en une seule fois
+    Ecran ecran = {0};  // Ce qui est affiché, pour ne réécrire que les lignes modifiées
+    ToucheClavier touches[TOUCHES_PAR_LOT];
+    double toucheNs = 0;  // Instant où est arrivé le dernier lot de touches
+    double latenceNs = 0; // Temps entre l'arrivée du dernier lot de touches et l'affichage de son image
+    const char *raison = NULL;
+    int solution = debug ? labyrinthe_solve(labyrinthe, &raison) : 0; // Plus court parcours, affiché en mode debug
+    clavierActiver();
+    tamponAjouter(&image, "%s", labyrinthe_message(labyrinthe)); // Message de l'entrée
+    while (!fini)
+    {
+        double debutAffichage = labyrinthe_stats_start();
+        tamponAjouter(&image, "\nIl reste " RED "%u" RESET " noeuds non explores\n\n", labyrinthe_unexplored(labyrinthe));
+        if (debug)
+        {
+            afficherDebug(labyrinthe, &ecran, latenceNs, solution, raison, &image);
+        }
+        else
+        {
+            afficherVueLabyrinthe(labyrinthe, false, &image);
+        }
+        if (!labyrinthe_random_next(labyrinthe))
+        {
+            tamponAjouter(&image, "Utilisez les fleches pour naviguer, Echap pour quitter.\n\n");
+        }
+        // on écrit d'un coup les lignes qui ont changé
+        ecranAfficher(&ecran, &image, stdout);
+        if (toucheNs != 0)
+        {
+            latenceNs = labyrinthe_clock() - toucheNs;
+        }
+        labyrinthe_stats_stop(LABYRINTHE_AFFICHAGE, debutAffichage);
+
+        // on attend des touches, ou le délai pour redessiner (changement de taille du terminal)
+        double debutAttente = labyrinthe_stats_start();
+        int nbTouches = lireTouches(touches, TOUCHES_PAR_LOT, DELAI_RAFRAICHISSEMENT_MS);
+        labyrinthe_stats_stop(LABYRINTHE_ATTENTE, debutAttente);
+        toucheNs = nbTouches > 0 ? labyrinthe_clock() : 0;
+        labyrinthe_stats_turn(nbTouches);
+        double debutLogique = labyrinthe_stats_start();
+        for (int t = 0; t < nbTouches && !fini; t++)
+        {
+            if (touches[t] == CLAVIER_ECHAP)
+            {
+                labyrinthe_stats_stop(LABYRINTHE_LOGIQUE, debutLogique); // L'image de fin attend une touche : elle n'est pas comptée
+                // Touche Echap pour quitter
+                tamponAjouter(&image, "Vous avez quitte le jeu.\n");
+                ecranAfficher(&ecran, &image, stdout);
+                attendreTouche();
+                fini = true;
+                break;
+            }
+            bool aleatoire = labyrinthe_random_next(labyrinthe);
+            if (touches[t] != CLAVIER_HAUT && touches[t] != CLAVIER_GAUCHE && touches[t] != CLAVIER_DROITE && !aleatoire)
+            {
+                continue; // Après la salle A, n'importe quelle touche donne le mouvement aléatoire
+            }
+            MouvementLabyrinthe mouvement = touches[t] == CLAVIER_GAUCHE   ? LABYRINTHE_GAUCHE
+                                            : touches[t] == CLAVIER_DROITE ? LABYRINTHE_DROITE
+                                                                           : LABYRINTHE_HAUT;
+            bool voisin = labyrinthe_neighbor(labyrinthe, labyrinthe_position(labyrinthe), mouvement) != LABYRINTHE_AUCUNE_SALLE;
+            ResultatPas resultat = labyrinthe_step(labyrinthe, mouvement);
+            tamponAjouter(&image, "%s", labyrinthe_message(labyrinthe));
+            if (resultat == LABYRINTHE_IMMOBILE && !voisin && !aleatoire)
+            {
+                tamponAjouter(&image, mouvement == LABYRINTHE_HAUT     ? "Pas de parent.\n"
+                                      : mouvement == LABYRINTHE_GAUCHE ? "Pas de noeud gauche.\n"
+                                                                       : "Pas de noeud droit.\n");
+            }
+            // Vérifier si le joueur a atteint la sortie
+            if (resultat == LABYRINTHE_GAGNE)
+            {
+                labyrinthe_stats_stop(LABYRINTHE_LOGIQUE, debutLogique);
+                tamponAjouter(&image, "Il restait %u noeuds non explores.\n", labyrinthe_unexplored(labyrinthe));
+                if (debug)
+                {
+                    afficherArbre(labyrinthe, 0, 0, &image);
+                }
+                else
+                {
+                    afficherVueLabyrinthe(labyrinthe, true, &image);
+                }
+                ecranAfficher(&ecran, &image, stdout);
+                attendreTouche();
+                effacerEcran();
+                fini = true;
+            }
+        }
+        if (!fini)
+        {
+            labyrinthe_stats_stop(LABYRINTHE_LOGIQUE, debutLogique);
+        }
+    }
+    clavierRestaurer();
+    tamponLiberer(&image);
+    ecranLiberer(&ecran);
+}
+
+/**
+ * Enregistrement d'une partie qui vient d'être jouée, pour pouvoir la rejouer.
+ * @param labyrinthe La partie, créée avec LABYRINTHE_JOURNAL.
+ * @param cheminLabyrinthe Le fichier où écrire le labyrinthe, NULL s'il est déjà dans un fichier.
+ */
+void enregistrerPartieLabyrinthe(Labyrinthe *labyrinthe, const char *cheminLabyrinthe)
+{
+    if (labyrinthe_save(labyrinthe, cheminLabyrinthe, FICHIER_PARTIE_JOURNAL))
+    {
+        printf("Partie enregistree dans %s (%u mouvement(s))\n", FICHIER_PARTIE_JOURNAL, labyrinthe_moves(labyrinthe));
+    }
+}
+
+/**
+ * Génération d'un labyrinthe, partie jouée au clavier puis enregistrée (modes mini, normal et debug).
+ * @param graine La graine du labyrinthe et de la partie.
+ * @param taille Le nombre de salles.
+ * @param options Les options de labyrinthe_new (événements, algorithme de génération).
+ * @param debug Vrai pour le mode debug.
+ */
+void jouerLabyrinthe(uint64_t graine, int taille, int options, bool debug)
+{
+    Labyrinthe *labyrinthe = labyrinthe_new(graine, (uint32_t)taille, options | LABYRINTHE_MESSAGES | LABYRINTHE_JOURNAL);
+    if (labyrinthe == NULL)
+    {
+        printf("Taille de labyrinthe impossible : %d\n", taille);
+        return;
+    }
+    if (debug)
+    {
+        printf("%u noeu(x) ont ete genere(s)\n\n", labyrinthe_size(labyrinthe));
+    }
+    else
+    {
+        // on clear la console
+        effacerEcran();
+    }
+    boucleJeuLabyrinthe(labyrinthe, debug); // on lance la boucle de jeu
+    enregistrerPartieLabyrinthe(labyrinthe, FICHIER_PARTIE_LABYRINTHE);
+    labyrinthe_free(labyrinthe);
+}
+
+int main(int argc, char **argv)
+{
+    // Graine pour les nombres aléatoires, l'heure si elle n'est pas donnée
+    uint64_t graine = (uint64_t)time(NULL);
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "--seed") == 0 || strcmp(argv[i], "--graine") == 0) && i + 1 < argc)
+        {
+            graine = strtoull(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--stats") == 0)
+        {
+            labyrinthe_stats_enable();
+            atexit(terminerStatistiques); // Aussi en cas de sortie sur erreur
+        }
+    }
+    uint64_t etat = graine; // Tire la graine de chaque labyrinthe
+    printf("Graine : %llu (--seed %llu pour rejouer les memes labyrinthes)\n", (unsigned long long)graine,
+           (unsigned long long)graine);
 
     // Taille de l'arbre
     int tailleArbre = 10;
 
+    // Algorithme de génération de l'arbre
+    AlgorithmeMenu algorithme = ALGORITHME_DESCENTE;
+
     int choix = 0;
     do
     {
@@ -48,57 +318,170 @@ void main(void)
         printf("3. Mode Debug (avec event et affichage debug)\n");
         printf("4. Affichage des regles\n");
         printf("5. Changer la taille de l'arbre (actuellement %d)\n", tailleArbre);
-        printf("6. Quitter\n");
+        printf("6. Changer l'algorithme de generation (actuellement %s)\n", algorithme == ALGORITHME_LINEAIRE    ? "lineaire"
+                                                                           : algorithme == ALGORITHME_PARALLELE ? "parallele"
+                                                                                                                : "descente");
+        printf("7. Generer un labyrinthe dans un fichier (meme plus grand que la memoire)\n");
+        printf("8. Ouvrir un labyrinthe sauvegarde\n");
+        printf("9. Exporter un labyrinthe sauvegarde (GraphViz ou JSON)\n");
+        printf("10. Rejouer une partie enregistree (labyrinthe et journal)\n");
+        printf("11. Quitter\n");
         printf("Votre choix : ");
         scanf("%d", &choix);
         switch (choix)
         {
         case 1:
             // Mode Mini
-            Arbre *arbreMini = init();               // Initialiser l'arbre
-            genererArbre(arbreMini, tailleArbre);    // Générer l'arbre avec un nombre de nœuds donné
-            arbreMini->current = arbreMini->premier; // on initialise la position du joueur
-            // on clear la console
-            system("cls");
-            boucleJeu(arbreMini, 0); // on lance la boucle de jeu
+            jouerLabyrinthe(labyrinthe_random(&etat), tailleArbre, optionsAlgorithme(algorithme), false);
             break;
         case 2:
-            // Mode Normal
-            Arbre *arbre = init();            // Initialiser l'arbre
-            genererArbre(arbre, tailleArbre); // Générer l'arbre avec un nombre de nœuds donné
-            genererEvents(arbre);             // Générer les événements
-            arbre->current = arbre->premier;  // on initialise la position du joueur
-            // on clear la console
-            system("cls");
-            boucleJeu(arbre, 0); // on lance la boucle de jeu
+            // Mode Normal : un labyrinthe qui a une solution
+            jouerLabyrinthe(labyrinthe_random(&etat), tailleArbre, optionsAlgorithme(algorithme) | LABYRINTHE_EVENEMENTS,
+                            false);
             break;
         case 3:
-            Arbre *arbreDebug = init();                // Initialiser l'arbre
-            genererArbre(arbreDebug, tailleArbre);     // Générer l'arbre avec un nombre de nœuds donné
-            genererEvents(arbreDebug);                 // Générer les événements
-            arbreDebug->current = arbreDebug->premier; // on initialise la position du joueur
-            printf("%d noeu(x) ont ete genere(s)\n\n", nombreElement(arbreDebug->premier));
-            // on affiche l'arbre
-            boucleJeu(arbreDebug, 1);
+            // Mode Debug
+            jouerLabyrinthe(labyrinthe_random(&etat), tailleArbre, optionsAlgorithme(algorithme) | LABYRINTHE_EVENEMENTS,
+                            true);
             break;
         case 4:
             afficherReglesDuJeu(); // Afficher les règles du jeu
             break;
         case 5:
             int taille = 0;
-            while (taille < 10 || taille > 50)
+            while (taille < 10 || taille > tailleMaximale(algorithme))
             {
-                printf("Entrez la taille de l'arbre : (entre 10 et 50) ");
+                printf("Entrez la taille de l'arbre : (entre 10 et %d) ", tailleMaximale(algorithme));
                 scanf("%d", &taille);
             }
             tailleArbre = taille;
             break;
         case 6:
+            // On passe d'un algorithme au suivant pour pouvoir les comparer
+            algorithme = algorithme == ALGORITHME_DESCENTE  ? ALGORITHME_LINEAIRE
+                         : algorithme == ALGORITHME_LINEAIRE ? ALGORITHME_PARALLELE
+                                                             : ALGORITHME_DESCENTE;
+            if (tailleArbre > tailleMaximale(algorithme))
+            {
+                tailleArbre = tailleMaximale(algorithme);
+            }
+            break;
+        case 7:
+            // Écrit au fil de la génération : la taille n'est limitée que par le disque
+            char cheminSauvegarde[256];
+            unsigned long nombreNoeuds = 0;
+            printf("Nom du fichier : ");
+            scanf("%255s", cheminSauvegarde);
+            while (nombreNoeuds < 10 || nombreNoeuds >= LABYRINTHE_AUCUNE_SALLE)
+            {
+                printf("Nombre de noeuds : (entre 10 et %lu) ", (unsigned long)LABYRINTHE_AUCUNE_SALLE - 1);
+                scanf("%lu", &nombreNoeuds);
+            }
+            double debutSauvegarde = labyrinthe_clock();
+            if (labyrinthe_generate_file(labyrinthe_random(&etat), (uint32_t)nombreNoeuds, cheminSauvegarde))
+            {
+                printf("%lu noeud(s) ecrit(s) dans %s en %.1f s\n", nombreNoeuds, cheminSauvegarde,
+                       (labyrinthe_clock() - debutSauvegarde) / 1e9);
+            }
+            break;
+        case 8:
+            char cheminOuverture[256];
+            printf("Nom du fichier : ");
+            scanf("%255s", cheminOuverture);
+            double debutOuverture = labyrinthe_clock();
+            Labyrinthe *labyrintheOuvert = labyrinthe_open(cheminOuverture, labyrinthe_random(&etat),
+                                                           LABYRINTHE_MESSAGES | LABYRINTHE_JOURNAL);
+            double dureeOuverture = labyrinthe_clock() - debutOuverture;
+            if (labyrintheOuvert != NULL)
+            {
+                effacerEcran();
+                boucleJeuLabyrinthe(labyrintheOuvert, false);
+                printf("%u noeud(s) ouvert(s) en %.2f ms\n", labyrinthe_size(labyrintheOuvert), dureeOuverture / 1e6);
+                enregistrerPartieLabyrinthe(labyrintheOuvert, NULL); // Le labyrinthe est déjà dans cheminOuverture
+                labyrinthe_free(labyrintheOuvert);
+            }
+            break;
+        case 9:
+            // Lu directement dans le fichier et écrit par lots : la taille n'est pas limitée par la mémoire
+            char cheminSource[256];
+            char cheminExport[256];
+            int format = 0;
+            printf("Nom du labyrinthe : ");
+            scanf("%255s", cheminSource);
+            Labyrinthe *labyrintheExporte = labyrinthe_open(cheminSource, 0, 0);
+            if (labyrintheExporte == NULL)
+            {
+                break;
+            }
+            while (format < 1 || format > 2)
+            {
+                printf("Format : (1 = GraphViz .dot, 2 = JSON lines) ");
+                scanf("%d", &format);
+            }
+            printf("Nom du fichier d'export : ");
+            scanf("%255s", cheminExport);
+            FILE *fichierExport = fopen(cheminExport, "wb");
+            if (fichierExport == NULL)
+            {
+                perror("Erreur d'ouverture du fichier d'export");
+                labyrinthe_free(labyrintheExporte);
+                break;
+            }
+            double debutExport = labyrinthe_clock();
+            bool exporte = labyrinthe_export(labyrintheExporte, format == 1 ? LABYRINTHE_DOT : LABYRINTHE_JSON, fichierExport);
+            if (fclose(fichierExport) == 0 && exporte)
+            {
+                printf("%u noeud(s) exporte(s) dans %s en %.1f s\n", labyrinthe_size(labyrintheExporte), cheminExport,
+                       (labyrinthe_clock() - debutExport) / 1e9);
+            }
+            else
+            {
+                perror("Erreur d'ecriture du fichier d'export");
+            }
+            labyrinthe_free(labyrintheExporte);
+            break;
+        case 10:
+            // Rejoue sans affichage, pour reproduire exactement une partie signalée
+            char cheminLabyrinthe[256];
+            char cheminJournal[256];
+            printf("Nom du labyrinthe : (%s, ou le fichier ouvert pendant la partie) ", FICHIER_PARTIE_LABYRINTHE);
+            scanf("%255s", cheminLabyrinthe);
+            printf("Nom du journal : (%s) ", FICHIER_PARTIE_JOURNAL);
+            scanf("%255s", cheminJournal);
+            Labyrinthe *labyrintheRejoue = labyrinthe_open(cheminLabyrinthe, 0, 0);
+            if (labyrintheRejoue == NULL)
+            {
+                break;
+            }
+            bool identique = false;
+            double debutRejeu = labyrinthe_clock();
+            if (labyrinthe_replay(labyrintheRejoue, cheminJournal, &identique))
+            {
+                double dureeRejeu = labyrinthe_clock() - debutRejeu;
+                uint32_t mouvements = labyrinthe_moves(labyrintheRejoue);
+                printf("Graine de la partie : %llu\n", (unsigned long long)labyrinthe_seed(labyrintheRejoue));
+                printf("%u mouvement(s) rejoue(s) en %.3f ms (%.1f millions par seconde)\n", mouvements,
+                       dureeRejeu / 1e6, mouvements / (dureeRejeu / 1e9) / 1e6);
+                if (identique)
+                {
+                    printf("Partie identique au journal : %s, %u noeud(s) non explore(s)\n",
+                           labyrinthe_won(labyrintheRejoue) ? "sortie trouvee" : "partie quittee",
+                           labyrinthe_unexplored(labyrintheRejoue));
+                }
+                else
+                {
+                    printf("La partie rejouee s'ecarte du journal apres %u mouvement(s)\n", mouvements);
+                }
+            }
+            labyrinthe_free(labyrintheRejoue);
+            break;
+        case 11:
             printf("Merci et au revoir !\n");
             break;
         default:
             printf("Choix invalide\n");
             break;
         }
-    } while (choix != 6);
-}
\ No newline at end of file
+    } while (choix != 11);
+    return 0;
+}
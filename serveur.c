@@ -0,0 +1,413 @@
+/**
+ * @file serveur.c
+ * @brief Serveur de parties simultanées sur une socket Unix
+ *
+ * Ce programme héberge un grand nombre de parties indépendantes dans un seul processus : chaque connexion
+ * à la socket est une partie (voir serveur.h pour le protocole). Quelques labyrinthes sont générés au départ
+ * puis partagés en lecture par toutes les parties (labyrinthe_join), qui n'allouent que leurs propres visites.
+ * Le serveur ne connaît le jeu que par labyrinthe.h : chaque commande est un labyrinthe_step.
+ *
+ * Le thread principal accepte les connexions et les répartit à tour de rôle entre un nombre fixe de threads,
+ * chacun avec sa propre instance epoll : une partie n'est jamais servie que par son thread, sans verrou.
+ * Un thread lit toutes les commandes disponibles sur une connexion et écrit toutes les réponses en une fois.
+ * Le serveur s'arrête proprement sur SIGINT ou SIGTERM.
+ *
+ * Utilisation : labyrinthe_serveur [--socket CHEMIN] [--threads K] [--taille T] [--labyrinthes L] [--graine G]
+ *
+ * @note Utilisation du compilateur GCC, sous Linux (epoll).
+ */
+
+#define _GNU_SOURCE // accept4
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "labyrinthe.h"
+#include "serveur.h"
+
+#define COMMANDES_PAR_LECTURE 64   // Commandes lues d'un coup sur une connexion, donc réponses en attente au plus
+#define EVENEMENTS_PAR_ATTENTE 256 // Connexions prêtes traitées par appel à epoll_wait
+#define DELAI_ARRET_MS 100         // Les threads vérifient la demande d'arrêt au moins aussi souvent
+
+typedef struct Session // Une connexion et sa partie, servies par un seul thread
+{
+    int fd;
+    bool attenteEcriture; // Le client ne lit pas assez vite : on attend de pouvoir écrire avant de lire
+    uint32_t debutSortie; // Premier octet des réponses qui n'a pas encore été écrit
+    uint32_t finSortie;   // Fin des réponses en attente, en octets
+    Labyrinthe *partie;
+    ReponseServeur sortie[COMMANDES_PAR_LECTURE];
+} Session;
+
+typedef struct Travailleur // Un thread, son instance epoll et ses compteurs
+{
+    int epoll;
+    pthread_t thread;
+    uint64_t commandes; // Commandes traitées
+    uint64_t fermees;   // Sessions terminées
+} Travailleur;
+
+static atomic_bool arret = false; // Demandé par SIGINT ou SIGTERM
+static Session **sessions;        // Session de chaque descripteur ouvert, pour tout libérer à l'arrêt
+static int nbDescripteurs;        // Taille de sessions
+
+/**
+ * Demande d'arrêt du serveur, sur SIGINT ou SIGTERM.
+ * @param signal Le signal reçu.
+ */
+static void demanderArret(int signal)
+{
+    (void)signal;
+    atomic_store(&arret, true);
+}
+
+/**
+ * Réponse à une commande : on la joue sur la partie, puis on décrit l'état de la partie.
+ * @param partie La partie.
+ * @param commande La commande (COMMANDE_HAUT...).
+ * @param reponse La réponse à remplir.
+ */
+static void repondre(Labyrinthe *partie, uint8_t commande, ReponseServeur *reponse)
+{
+    reponse->resultat = REPONSE_IMMOBILE;
+    switch (commande)
+    {
+    case COMMANDE_HAUT:
+    case COMMANDE_GAUCHE:
+    case COMMANDE_DROITE:
+        switch (labyrinthe_step(partie, commande == COMMANDE_HAUT     ? LABYRINTHE_HAUT
+                                        : commande == COMMANDE_GAUCHE ? LABYRINTHE_GAUCHE
+                                                                      : LABYRINTHE_DROITE))
+        {
+        case LABYRINTHE_GAGNE:
+            reponse->resultat = REPONSE_GAGNE;
+            break;
+        case LABYRINTHE_DEPLACE:
+            reponse->resultat = REPONSE_DEPLACE;
+            break;
+        case LABYRINTHE_IMMOBILE:
+            break;
+        }
+        break;
+    case COMMANDE_RECOMMENCER:
+        // La graine de la nouvelle partie suit celle de la précédente : la session reste reproductible
+        uint64_t graine = labyrinthe_seed(partie);
+        labyrinthe_reset(partie, labyrinthe_random(&graine));
+        reponse->resultat = REPONSE_DEPLACE;
+        break;
+    case COMMANDE_ETAT:
+        break;
+    default:
+        reponse->resultat = REPONSE_ERREUR;
+        break;
+    }
+    uint32_t position = labyrinthe_position(partie);
+    reponse->salle = labyrinthe_event(partie, position);
+    reponse->drapeaux = (labyrinthe_has_key(partie) ? REPONSE_CLE : 0) | (labyrinthe_random_next(partie) ? REPONSE_ALEATOIRE : 0);
+    reponse->reserve = 0;
+    reponse->position = position;
+    reponse->nbNonExplores = labyrinthe_unexplored(partie);
+}
+
+/**
+ * Écriture des réponses en attente d'une session, autant que la socket en accepte.
+ * @param session La session.
+ * @return false si la connexion est perdue.
+ */
+static bool ecrireSortie(Session *session)
+{
+    while (session->debutSortie < session->finSortie)
+    {
+        ssize_t ecrits = send(session->fd, (char *)session->sortie + session->debutSortie,
+                              session->finSortie - session->debutSortie, MSG_NOSIGNAL);
+        if (ecrits < 0)
+        {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        session->debutSortie += (uint32_t)ecrits;
+    }
+    session->debutSortie = session->finSortie = 0;
+    return true;
+}
+
+/**
+ * Service d'une session prête : réponses en retard, puis toutes les commandes disponibles.
+ * @param session La session.
+ * @param travailleur Le thread qui la sert.
+ * @return false si la connexion est terminée.
+ */
+static bool servirSession(Session *session, Travailleur *travailleur)
+{
+    if (!ecrireSortie(session))
+    {
+        return false;
+    }
+    if (session->finSortie == 0)
+    {
+        uint8_t commandes[COMMANDES_PAR_LECTURE];
+        ssize_t lus = recv(session->fd, commandes, sizeof(commandes), 0);
+        if (lus == 0)
+        {
+            return false; // Le client a fermé la connexion
+        }
+        if (lus < 0)
+        {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        for (ssize_t i = 0; i < lus; i++)
+        {
+            repondre(session->partie, commandes[i], &session->sortie[i]);
+        }
+        session->finSortie = (uint32_t)lus * sizeof(ReponseServeur);
+        travailleur->commandes += (uint64_t)lus;
+        if (!ecrireSortie(session))
+        {
+            return false;
+        }
+    }
+
+    // Tant que des réponses attendent, on ne lit plus de commandes : le client qui ne lit pas est freiné
+    bool attenteEcriture = session->finSortie > 0;
+    if (attenteEcriture != session->attenteEcriture)
+    {
+        struct epoll_event evenement = {.events = attenteEcriture ? EPOLLOUT : EPOLLIN, .data.ptr = session};
+        epoll_ctl(travailleur->epoll, EPOLL_CTL_MOD, session->fd, &evenement);
+        session->attenteEcriture = attenteEcriture;
+    }
+    return true;
+}
+
+/**
+ * Fin d'une session : la connexion est fermée et la partie libérée.
+ * @param session La session.
+ */
+static void fermerSession(Session *session)
+{
+    sessions[session->fd] = NULL; // Avant close : le descripteur peut être réutilisé aussitôt
+    close(session->fd);
+    labyrinthe_free(session->partie);
+    free(session);
+}
+
+/**
+ * Travail d'un thread : servir ses sessions jusqu'à l'arrêt du serveur.
+ * @param argument Le Travailleur du thread.
+ * @return NULL.
+ */
+static void *travaillerServeur(void *argument)
+{
+    Travailleur *travailleur = argument;
+    struct epoll_event evenements[EVENEMENTS_PAR_ATTENTE];
+    while (!atomic_load(&arret))
+    {
+        int nbPretes = epoll_wait(travailleur->epoll, evenements, EVENEMENTS_PAR_ATTENTE, DELAI_ARRET_MS);
+        for (int i = 0; i < nbPretes; i++)
+        {
+            Session *session = evenements[i].data.ptr;
+            if ((evenements[i].events & (EPOLLERR | EPOLLHUP)) && !(evenements[i].events & EPOLLIN))
+            {
+                fermerSession(session);
+                travailleur->fermees++;
+            }
+            else if (!servirSession(session, travailleur))
+            {
+                fermerSession(session);
+                travailleur->fermees++;
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Ouverture de la socket d'écoute, en remplaçant une socket laissée par un serveur précédent.
+ * @param chemin Le chemin de la socket.
+ * @return le descripteur de la socket, -1 en cas d'erreur.
+ */
+static int ecouter(const char *chemin)
+{
+    struct sockaddr_un adresse = {.sun_family = AF_UNIX};
+    if (strlen(chemin) >= sizeof(adresse.sun_path))
+    {
+        fprintf(stderr, "Chemin de socket trop long : %s\n", chemin);
+        return -1;
+    }
+    strcpy(adresse.sun_path, chemin);
+    int ecoute = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (ecoute < 0)
+    {
+        perror("Erreur de création de la socket");
+        return -1;
+    }
+    unlink(chemin);
+    if (bind(ecoute, (struct sockaddr *)&adresse, sizeof(adresse)) < 0 || listen(ecoute, SOMAXCONN) < 0)
+    {
+        perror("Erreur d'ouverture de la socket");
+        close(ecoute);
+        return -1;
+    }
+    return ecoute;
+}
+
+/**
+ * Autant de descripteurs que le système le permet : une connexion par partie.
+ * @return le nombre maximum de descripteurs ouverts.
+ */
+static int augmenterDescripteurs()
+{
+    struct rlimit limite;
+    if (getrlimit(RLIMIT_NOFILE, &limite) != 0)
+    {
+        return 1024;
+    }
+    limite.rlim_cur = limite.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limite);
+    getrlimit(RLIMIT_NOFILE, &limite);
+    return limite.rlim_cur > (rlim_t)(1 << 24) ? 1 << 24 : (int)limite.rlim_cur;
+}
+
+int main(int argc, char **argv)
+{
+    const char *chemin = CHEMIN_SOCKET;
+    int nbThreads = labyrinthe_threads();
+    int taille = 1000;
+    int nbLabyrinthes = 16;
+    uint64_t graine = 12122024; // Graine fixe pour des parties reproductibles
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool valeur = i + 1 < argc;
+        if (strcmp(argv[i], "--socket") == 0 && valeur)
+            chemin = argv[++i];
+        else if (strcmp(argv[i], "--threads") == 0 && valeur)
+            nbThreads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--taille") == 0 && valeur)
+            taille = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--labyrinthes") == 0 && valeur)
+            nbLabyrinthes = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "--graine") == 0 || strcmp(argv[i], "--seed") == 0) && valeur)
+            graine = strtoull(argv[++i], NULL, 10);
+        else
+        {
+            fprintf(stderr, "Utilisation : %s [--socket CHEMIN] [--threads K] [--taille T] [--labyrinthes L] [--graine G]\n",
+                    argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (taille < 2 || nbLabyrinthes < 1 || nbThreads < 1)
+    {
+        fprintf(stderr, "Il faut au moins 2 noeuds, 1 labyrinthe et 1 thread.\n");
+        return EXIT_FAILURE;
+    }
+
+    // Les labyrinthes, tous avec une solution, sont générés une fois et seulement lus ensuite
+    uint64_t etat = graine;
+    Labyrinthe **labyrinthes = malloc(nbLabyrinthes * sizeof(Labyrinthe *));
+    nbDescripteurs = augmenterDescripteurs();
+    sessions = calloc(nbDescripteurs, sizeof(Session *));
+    Travailleur *travailleurs = calloc(nbThreads, sizeof(Travailleur));
+    if (labyrinthes == NULL || sessions == NULL || travailleurs == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour le serveur");
+        return EXIT_FAILURE;
+    }
+    for (int l = 0; l < nbLabyrinthes; l++)
+    {
+        labyrinthes[l] = labyrinthe_new(labyrinthe_random(&etat), (uint32_t)taille, LABYRINTHE_EVENEMENTS);
+    }
+
+    int ecoute = ecouter(chemin);
+    if (ecoute < 0)
+    {
+        return EXIT_FAILURE;
+    }
+    // Sans SA_RESTART : accept est interrompu par le signal d'arrêt
+    struct sigaction action = {.sa_handler = demanderArret};
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    for (int t = 0; t < nbThreads; t++)
+    {
+        travailleurs[t].epoll = epoll_create1(EPOLL_CLOEXEC);
+        if (travailleurs[t].epoll < 0 || pthread_create(&travailleurs[t].thread, NULL, travaillerServeur, &travailleurs[t]) != 0)
+        {
+            perror("Erreur de création d'un thread");
+            return EXIT_FAILURE;
+        }
+    }
+    printf("Serveur sur %s : %d labyrinthes de %d noeuds, graine %llu, %d thread(s), %d connexions au plus\n", chemin,
+           nbLabyrinthes, taille, (unsigned long long)graine, nbThreads, nbDescripteurs);
+    fflush(stdout);
+
+    // Le thread principal accepte les connexions et les répartit à tour de rôle
+    uint64_t nbSessions = 0;
+    while (!atomic_load(&arret))
+    {
+        int fd = accept4(ecoute, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno != EINTR && errno != EAGAIN)
+            {
+                perror("Erreur d'acceptation d'une connexion");
+                usleep(DELAI_ARRET_MS * 1000); // Trop de connexions ouvertes : on laisse les threads en fermer
+            }
+            continue;
+        }
+        Session *session = calloc(1, sizeof(Session));
+        if (session == NULL || fd >= nbDescripteurs)
+        {
+            fprintf(stderr, "Connexion refusee : plus de place pour une nouvelle partie\n");
+            free(session);
+            close(fd);
+            continue;
+        }
+        // La graine de la partie ne dépend que du numéro de la session
+        session->fd = fd;
+        session->partie = labyrinthe_join(labyrinthes[nbSessions % nbLabyrinthes], graine ^ (nbSessions * 0xD1B54A32D192ED03ull), 0);
+        sessions[fd] = session;
+        struct epoll_event evenement = {.events = EPOLLIN, .data.ptr = session};
+        epoll_ctl(travailleurs[nbSessions % nbThreads].epoll, EPOLL_CTL_ADD, fd, &evenement);
+        nbSessions++;
+    }
+
+    // Arrêt : les threads finissent leur tour, puis on libère les sessions encore ouvertes
+    uint64_t commandes = 0, fermees = 0;
+    for (int t = 0; t < nbThreads; t++)
+    {
+        pthread_join(travailleurs[t].thread, NULL);
+        close(travailleurs[t].epoll);
+        commandes += travailleurs[t].commandes;
+        fermees += travailleurs[t].fermees;
+    }
+    for (int fd = 0; fd < nbDescripteurs; fd++)
+    {
+        if (sessions[fd] != NULL)
+        {
+            fermerSession(sessions[fd]);
+        }
+    }
+    close(ecoute);
+    unlink(chemin);
+    printf("\nArret : %llu session(s) servie(s) (%llu fermee(s) par le client), %llu commande(s)\n",
+           (unsigned long long)nbSessions, (unsigned long long)fermees, (unsigned long long)commandes);
+
+    for (int l = 0; l < nbLabyrinthes; l++)
+    {
+        labyrinthe_free(labyrinthes[l]);
+    }
+    free(labyrinthes);
+    free(sessions);
+    free(travailleurs);
+    return 0;
+}
@@ -0,0 +1,51 @@
+/**
+ * @file serveur.h
+ * @brief Protocole du serveur de parties (serveur.c) et de son client de charge (charge.c)
+ *
+ * Chaque connexion à la socket Unix du serveur est une partie. Le client envoie des commandes d'un octet,
+ * éventuellement plusieurs à la suite sans attendre les réponses ; le serveur répond à chacune, dans l'ordre,
+ * par une ReponseServeur de 12 octets. La socket est locale : les entiers sont dans l'ordre de la machine.
+ *
+ * Les structures principales incluent :
+ * - ReponseServeur : Réponse à une commande, avec l'état de la partie.
+ *
+ * @note Utilisation du compilateur GCC, sous Linux (epoll).
+ */
+
+#ifndef SERVEUR_H
+#define SERVEUR_H
+
+#include <stdint.h>
+
+#define CHEMIN_SOCKET "/tmp/labyrinthe.sock" // Socket par défaut
+
+// Commandes, un octet chacune
+#define COMMANDE_HAUT 'H'        // Vers le parent
+#define COMMANDE_GAUCHE 'G'      // Vers le fils gauche
+#define COMMANDE_DROITE 'D'      // Vers le fils droit
+#define COMMANDE_RECOMMENCER 'R' // Nouvelle partie sur le même labyrinthe, à l'entrée
+#define COMMANDE_ETAT 'E'        // État de la partie, sans mouvement
+
+// Résultat d'une commande
+#define REPONSE_IMMOBILE 0 // Pas de déplacement : pas de salle, porte fermée, ou partie finie
+#define REPONSE_DEPLACE 1  // Le joueur a changé de salle (ou la partie a recommencé)
+#define REPONSE_GAGNE 2    // Le joueur a atteint la sortie
+#define REPONSE_ERREUR 3   // Commande inconnue
+
+// Drapeaux de l'état de la partie
+#define REPONSE_CLE 1       // Le joueur a la clé
+#define REPONSE_ALEATOIRE 2 // Le prochain mouvement sera aléatoire (salle A)
+
+typedef struct ReponseServeur // Réponse à une commande, 12 octets
+{
+    uint8_t resultat;       // REPONSE_IMMOBILE, REPONSE_DEPLACE, REPONSE_GAGNE ou REPONSE_ERREUR
+    char salle;             // Événement de la salle où se trouve le joueur
+    uint8_t drapeaux;       // REPONSE_CLE, REPONSE_ALEATOIRE
+    uint8_t reserve;        // À zéro
+    uint32_t position;      // Indice de la salle où se trouve le joueur
+    uint32_t nbNonExplores; // Nombre de salles non visitées
+} ReponseServeur;
+
+_Static_assert(sizeof(ReponseServeur) == 12, "ReponseServeur fait partie du protocole : 12 octets sans remplissage");
+
+#endif // SERVEUR_H
@@ -0,0 +1,443 @@
+/**
+ * @file simulation.c
+ * @brief Simulation de parties en masse, sans affichage
+ *
+ * Ce programme joue un grand nombre de parties avec des joueurs automatiques, sur tous les cœurs,
+ * pour régler la taille du labyrinthe et le choix des événements sans jouer à la main :
+ * - hasard : chaque mouvement est tiré au hasard parmi les mouvements possibles.
+ * - profondeur : exploration en profondeur d'abord, gauche puis droite, en remontant quand un sous-arbre est fini.
+ * - glouton : va vers un voisin où il n'est jamais allé s'il y en a, au hasard sinon.
+ *
+ * Quelques labyrinthes sont générés au départ avec une graine fixe, puis partagés en lecture par tous les threads
+ * (labyrinthe_join) ; chaque partie n'alloue que ses propres visites. Le programme ne connaît le jeu que par
+ * labyrinthe.h : les agents jouent avec labyrinthe_step, comme le joueur du menu. Les parties sont distribuées par paquets grâce à un compteur
+ * partagé : un thread qui finit en avance prend simplement le paquet suivant.
+ * La graine de chaque partie ne dépend que de son numéro : les résultats ne dépendent pas du nombre de threads.
+ *
+ * Utilisation : labyrinthe_simulation [--parties N] [--taille T] [--labyrinthes L] [--threads K]
+ *                                     [--graine G] [--agent hasard|profondeur|glouton] [--echelle]
+ *
+ * @note Utilisation du compilateur GCC.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "labyrinthe.h"
+
+#define TAILLE_PAQUET 256        // Nombre de parties prises d'un coup par un thread
+#define LIMITE_PAR_NOEUD 100     // Une partie est abandonnée après LIMITE_PAR_NOEUD * taille mouvements
+
+typedef enum Agent // Joueurs automatiques
+{
+    AGENT_HASARD,
+    AGENT_PROFONDEUR,
+    AGENT_GLOUTON,
+    NB_AGENTS
+} Agent;
+
+static const char *nomsAgents[NB_AGENTS] = {"hasard", "profondeur", "glouton"};
+
+typedef struct Statistiques // Résultats cumulés d'un ensemble de parties
+{
+    uint64_t parties;
+    uint64_t gagnees;
+    uint64_t mouvements; // Somme des mouvements jusqu'à la sortie, parties gagnées seulement
+    uint64_t mouvementsMin;
+    uint64_t mouvementsMax;
+    uint64_t partiesAvecChute; // Parties où la salle U s'est déclenchée
+    uint64_t partiesAvecOubli; // Parties où la salle R s'est déclenchée
+    uint64_t chutes;
+    uint64_t oublis;
+    uint64_t nonExplores; // Somme des nœuds non explorés à la sortie, parties gagnées seulement
+} Statistiques;
+
+typedef struct Simulation // Paramètres et travail partagés par tous les threads
+{
+    Labyrinthe **labyrinthes;  // Une partie sur chaque labyrinthe, que les threads rejoignent
+    int nbLabyrinthes;
+    Agent agent;
+    uint64_t nbParties;
+    uint64_t graine;
+    atomic_uint_fast64_t prochainePartie; // Numéro de la prochaine partie à distribuer
+} Simulation;
+
+typedef struct Travailleur // Un thread et ses résultats
+{
+    Simulation *simulation;
+    Statistiques statistiques;
+    pthread_t thread;
+} Travailleur;
+
+/**
+ * Test d'un bit dans un tableau de bits.
+ * @param bits Le tableau de bits.
+ * @param i L'indice du bit.
+ * @return vrai si le bit est à 1.
+ */
+static inline bool bitActif(const uint64_t *bits, uint32_t i)
+{
+    return (bits[i / 64] >> (i % 64)) & 1;
+}
+
+/**
+ * Tirage uniforme d'un entier dans [0, borne[ pour les agents.
+ * @param etat L'état du générateur de l'agent, mis à jour.
+ * @param borne Le nombre de valeurs possibles, au moins 1.
+ * @return l'entier tiré.
+ */
+static inline int tirerBorne(uint64_t *etat, int borne)
+{
+    return (int)(((labyrinthe_random(etat) >> 32) * (uint64_t)borne) >> 32);
+}
+
+/**
+ * Choix du prochain mouvement d'un joueur automatique.
+ * @param agent Le joueur automatique.
+ * @param partie La partie en cours.
+ * @param memoire La mémoire de l'agent, un bit par nœud : pour l'exploration en profondeur, les nœuds dont
+ *                le sous-arbre a été entièrement parcouru ; pour le glouton, les nœuds où il est déjà allé.
+ * @param etat Le générateur de l'agent, pour ses choix au hasard.
+ * @return le mouvement joué, -1 si l'agent ne peut aller nulle part.
+ */
+static int choisirMouvement(Agent agent, const Labyrinthe *partie, uint64_t *memoire, uint64_t *etat)
+{
+    uint32_t current = labyrinthe_position(partie);
+    bool porteFermee = labyrinthe_event(partie, current) == 'D' && !labyrinthe_has_key(partie);
+    uint32_t voisins[3] = {labyrinthe_neighbor(partie, current, LABYRINTHE_HAUT),
+                           porteFermee ? LABYRINTHE_AUCUNE_SALLE : labyrinthe_neighbor(partie, current, LABYRINTHE_GAUCHE),
+                           porteFermee ? LABYRINTHE_AUCUNE_SALLE : labyrinthe_neighbor(partie, current, LABYRINTHE_DROITE)};
+    static const MouvementLabyrinthe touches[3] = {LABYRINTHE_HAUT, LABYRINTHE_GAUCHE, LABYRINTHE_DROITE};
+
+    if (agent == AGENT_PROFONDEUR)
+    {
+        // Premier enfant dont le sous-arbre n'est pas fini, sinon ce sous-arbre est fini et on remonte
+        for (int v = 1; v < 3; v++)
+        {
+            if (voisins[v] != LABYRINTHE_AUCUNE_SALLE && !bitActif(memoire, voisins[v]))
+            {
+                return touches[v];
+            }
+        }
+        if (!porteFermee) // Derrière une porte fermée, le sous-arbre reste à parcourir avec la clé
+        {
+            memoire[current / 64] |= (uint64_t)1 << (current % 64);
+        }
+        return LABYRINTHE_HAUT;
+    }
+
+    int possibles[3], nbPossibles = 0;
+    if (agent == AGENT_GLOUTON)
+    {
+        // L'agent retient les salles où il est allé : l'affichage seul ne suffit pas,
+        // le brouillard n'est jamais marqué visité et la salle R efface les visites
+        memoire[current / 64] |= (uint64_t)1 << (current % 64);
+        for (int v = 0; v < 3; v++)
+        {
+            if (voisins[v] != LABYRINTHE_AUCUNE_SALLE && !bitActif(memoire, voisins[v]))
+            {
+                possibles[nbPossibles++] = v;
+            }
+        }
+    }
+    if (nbPossibles == 0)
+    {
+        for (int v = 0; v < 3; v++)
+        {
+            if (voisins[v] != LABYRINTHE_AUCUNE_SALLE)
+            {
+                possibles[nbPossibles++] = v;
+            }
+        }
+    }
+    return nbPossibles == 0 ? -1 : (int)touches[possibles[tirerBorne(etat, nbPossibles)]];
+}
+
+/**
+ * Ajout des résultats d'une partie terminée aux statistiques.
+ * @param statistiques Les statistiques.
+ * @param partie La partie terminée (gagnée ou abandonnée).
+ */
+static void compterPartie(Statistiques *statistiques, const Labyrinthe *partie)
+{
+    uint32_t chutes = labyrinthe_falls(partie);
+    uint32_t oublis = labyrinthe_forgets(partie);
+    uint32_t mouvements = labyrinthe_moves(partie);
+    statistiques->parties++;
+    statistiques->partiesAvecChute += chutes > 0;
+    statistiques->partiesAvecOubli += oublis > 0;
+    statistiques->chutes += chutes;
+    statistiques->oublis += oublis;
+    if (labyrinthe_won(partie))
+    {
+        statistiques->gagnees++;
+        statistiques->mouvements += mouvements;
+        statistiques->nonExplores += labyrinthe_unexplored(partie);
+        if (statistiques->gagnees == 1 || mouvements < statistiques->mouvementsMin)
+        {
+            statistiques->mouvementsMin = mouvements;
+        }
+        if (mouvements > statistiques->mouvementsMax)
+        {
+            statistiques->mouvementsMax = mouvements;
+        }
+    }
+}
+
+/**
+ * Fusion des statistiques d'un thread dans le total.
+ * @param total Les statistiques totales.
+ * @param ajout Les statistiques à ajouter.
+ */
+static void fusionnerStatistiques(Statistiques *total, const Statistiques *ajout)
+{
+    if (ajout->gagnees > 0 && (total->gagnees == 0 || ajout->mouvementsMin < total->mouvementsMin))
+    {
+        total->mouvementsMin = ajout->mouvementsMin;
+    }
+    if (ajout->mouvementsMax > total->mouvementsMax)
+    {
+        total->mouvementsMax = ajout->mouvementsMax;
+    }
+    total->parties += ajout->parties;
+    total->gagnees += ajout->gagnees;
+    total->mouvements += ajout->mouvements;
+    total->partiesAvecChute += ajout->partiesAvecChute;
+    total->partiesAvecOubli += ajout->partiesAvecOubli;
+    total->chutes += ajout->chutes;
+    total->oublis += ajout->oublis;
+    total->nonExplores += ajout->nonExplores;
+}
+
+/**
+ * Travail d'un thread : prendre des paquets de parties tant qu'il en reste, et les jouer.
+ * @param argument Le Travailleur du thread.
+ * @return NULL.
+ */
+static void *travailler(void *argument)
+{
+    Travailleur *travailleur = argument;
+    Simulation *simulation = travailleur->simulation;
+    uint32_t taille = labyrinthe_size(simulation->labyrinthes[0]);
+
+    // Une partie par labyrinthe, réutilisée d'une partie à l'autre
+    Labyrinthe **parties = malloc(simulation->nbLabyrinthes * sizeof(Labyrinthe *));
+    uint64_t *memoire = malloc((taille + 63) / 64 * sizeof(uint64_t));
+    if (parties == NULL || memoire == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour les parties");
+        exit(EXIT_FAILURE);
+    }
+    for (int l = 0; l < simulation->nbLabyrinthes; l++)
+    {
+        parties[l] = labyrinthe_join(simulation->labyrinthes[l], 0, 0);
+    }
+    uint64_t limite = (uint64_t)LIMITE_PAR_NOEUD * taille;
+    Statistiques statistiques = {0}; // Cumulées localement : les Travailleur voisins partagent des lignes de cache
+
+    while (1)
+    {
+        uint64_t debut = atomic_fetch_add(&simulation->prochainePartie, TAILLE_PAQUET);
+        if (debut >= simulation->nbParties)
+        {
+            break;
+        }
+        uint64_t fin = debut + TAILLE_PAQUET < simulation->nbParties ? debut + TAILLE_PAQUET : simulation->nbParties;
+        for (uint64_t numero = debut; numero < fin; numero++)
+        {
+            // La graine de la partie ne dépend que de son numéro
+            Labyrinthe *partie = parties[numero % simulation->nbLabyrinthes];
+            uint64_t etat = simulation->graine ^ (numero * 0xD1B54A32D192ED03ull);
+            labyrinthe_reset(partie, etat);
+            memset(memoire, 0, (taille + 63) / 64 * sizeof(uint64_t));
+            while (!labyrinthe_won(partie) && labyrinthe_moves(partie) < limite)
+            {
+                int mouvement = choisirMouvement(simulation->agent, partie, memoire, &etat);
+                if (mouvement < 0 || labyrinthe_step(partie, (MouvementLabyrinthe)mouvement) == LABYRINTHE_IMMOBILE)
+                {
+                    break; // Aucun mouvement possible : l'agent est bloqué
+                }
+            }
+            compterPartie(&statistiques, partie);
+        }
+    }
+
+    travailleur->statistiques = statistiques;
+    for (int l = 0; l < simulation->nbLabyrinthes; l++)
+    {
+        labyrinthe_free(parties[l]);
+    }
+    free(parties);
+    free(memoire);
+    return NULL;
+}
+
+/**
+ * Simulation de toutes les parties d'un agent avec un nombre de threads donné.
+ * @param simulation Les paramètres (le compteur de parties est remis à zéro).
+ * @param nbThreads Le nombre de threads.
+ * @param total Les statistiques de toutes les parties.
+ * @return la durée en secondes.
+ */
+static double simuler(Simulation *simulation, int nbThreads, Statistiques *total)
+{
+    Travailleur *travailleurs = calloc(nbThreads, sizeof(Travailleur));
+    if (travailleurs == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour les threads");
+        exit(EXIT_FAILURE);
+    }
+    atomic_store(&simulation->prochainePartie, 0);
+    memset(total, 0, sizeof(*total));
+
+    double debut = labyrinthe_clock();
+    for (int t = 0; t < nbThreads; t++)
+    {
+        travailleurs[t].simulation = simulation;
+        if (pthread_create(&travailleurs[t].thread, NULL, travailler, &travailleurs[t]) != 0)
+        {
+            perror("Erreur de création d'un thread");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int t = 0; t < nbThreads; t++)
+    {
+        pthread_join(travailleurs[t].thread, NULL);
+        fusionnerStatistiques(total, &travailleurs[t].statistiques);
+    }
+    double duree = (labyrinthe_clock() - debut) / 1e9;
+    free(travailleurs);
+    return duree;
+}
+
+/**
+ * Affichage des statistiques d'un agent.
+ * @param agent L'agent.
+ * @param s Les statistiques de ses parties.
+ * @param taille Le nombre de nœuds des labyrinthes.
+ * @param duree La durée de la simulation, en secondes.
+ * @param nbThreads Le nombre de threads utilisés.
+ */
+static void afficherStatistiques(Agent agent, const Statistiques *s, uint32_t taille, double duree, int nbThreads)
+{
+    double parties = s->parties > 0 ? (double)s->parties : 1;
+    double gagnees = s->gagnees > 0 ? (double)s->gagnees : 1;
+    printf("Agent %s : %llu parties en %.2f s, %.0f parties/s avec %d thread(s)\n", nomsAgents[agent],
+           (unsigned long long)s->parties, duree, s->parties / duree, nbThreads);
+    printf("  sortie trouvee : %.2f %% des parties (les autres abandonnees apres %d mouvements par noeud)\n",
+           100.0 * s->gagnees / parties, LIMITE_PAR_NOEUD);
+    printf("  mouvements jusqu'a la sortie : moyenne %.1f, min %llu, max %llu\n", s->mouvements / gagnees,
+           (unsigned long long)s->mouvementsMin, (unsigned long long)s->mouvementsMax);
+    printf("  U declenche dans %.2f %% des parties (%.3f par partie), R dans %.2f %% (%.3f par partie)\n",
+           100.0 * s->partiesAvecChute / parties, s->chutes / parties, 100.0 * s->partiesAvecOubli / parties, s->oublis / parties);
+    printf("  noeuds non explores a la sortie : moyenne %.1f (%.1f %% du labyrinthe)\n\n", s->nonExplores / gagnees,
+           100.0 * s->nonExplores / gagnees / taille);
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t nbParties = 100000;
+    int taille = 50;
+    int nbLabyrinthes = 16;
+    int nbThreads = labyrinthe_threads();
+    uint64_t graine = 12122024; // Graine fixe pour des résultats reproductibles
+    int agentChoisi = -1;           // Tous les agents par défaut
+    bool echelle = false;           // Mesure du débit pour 1, 2, 4 ... threads
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool valeur = i + 1 < argc;
+        if (strcmp(argv[i], "--parties") == 0 && valeur)
+            nbParties = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--taille") == 0 && valeur)
+            taille = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--labyrinthes") == 0 && valeur)
+            nbLabyrinthes = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && valeur)
+            nbThreads = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "--graine") == 0 || strcmp(argv[i], "--seed") == 0) && valeur)
+            graine = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--echelle") == 0)
+            echelle = true;
+        else if (strcmp(argv[i], "--agent") == 0 && valeur)
+        {
+            i++;
+            for (int a = 0; a < NB_AGENTS; a++)
+            {
+                if (strcmp(argv[i], nomsAgents[a]) == 0)
+                    agentChoisi = a;
+            }
+            if (agentChoisi < 0)
+            {
+                fprintf(stderr, "Agent inconnu : %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "Utilisation : %s [--parties N] [--taille T] [--labyrinthes L] [--threads K] [--graine G] "
+                            "[--agent hasard|profondeur|glouton] [--echelle]\n",
+                    argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (taille < 2 || nbLabyrinthes < 1 || nbThreads < 1)
+    {
+        fprintf(stderr, "Il faut au moins 2 noeuds, 1 labyrinthe et 1 thread.\n");
+        return EXIT_FAILURE;
+    }
+
+    // Les labyrinthes, tous avec une solution, sont générés une fois et seulement lus ensuite
+    uint64_t etat = graine;
+    Simulation simulation = {0};
+    simulation.labyrinthes = malloc(nbLabyrinthes * sizeof(Labyrinthe *));
+    if (simulation.labyrinthes == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour les labyrinthes");
+        return EXIT_FAILURE;
+    }
+    for (int l = 0; l < nbLabyrinthes; l++)
+    {
+        simulation.labyrinthes[l] = labyrinthe_new(labyrinthe_random(&etat), (uint32_t)taille, LABYRINTHE_EVENEMENTS);
+    }
+    simulation.nbLabyrinthes = nbLabyrinthes;
+    simulation.nbParties = nbParties;
+    simulation.graine = graine;
+    printf("%d labyrinthes de %d noeuds, graine %llu, %d coeur(s)\n\n", nbLabyrinthes, taille, (unsigned long long)graine, labyrinthe_threads());
+
+    for (int a = 0; a < NB_AGENTS; a++)
+    {
+        if (agentChoisi >= 0 && a != agentChoisi)
+        {
+            continue;
+        }
+        simulation.agent = a;
+        Statistiques total;
+        if (echelle)
+        {
+            double reference = 0;
+            for (int t = 1;; t = t * 2 < nbThreads ? t * 2 : nbThreads)
+            {
+                double duree = simuler(&simulation, t, &total);
+                double debit = total.parties / duree;
+                if (t == 1)
+                    reference = debit;
+                printf("Agent %s, %d thread(s) : %.0f parties/s, acceleration %.2f\n", nomsAgents[a], t, debit, debit / reference);
+                if (t == nbThreads)
+                    break;
+            }
+        }
+        double duree = simuler(&simulation, nbThreads, &total);
+        afficherStatistiques(a, &total, taille, duree, nbThreads);
+    }
+
+    for (int l = 0; l < nbLabyrinthes; l++)
+    {
+        labyrinthe_free(simulation.labyrinthes[l]);
+    }
+    free(simulation.labyrinthes);
+    return 0;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file tampon.c
+ * @brief Tampon de texte extensible, partagé par le moteur et l'affichage
+ *
+ * Ce fichier est inclus par toolBox.c, après maintenantNs qui date le début de chaque image :
+ * il est donc compilé dans la bibliothèque labyrinthe, et déclaré pour les autres fichiers par tampon.h.
+ *
+ * Les fonctions principales incluent :
+ * - tamponAjouter : Ajoute du texte formaté, le tampon grandit si nécessaire.
+ * - tamponEnvoyer : Écrit le tampon en un seul appel, puis le vide.
+ * - tamponLiberer : Libère la mémoire du tampon.
+ *
+ * @note Utilisation du compilateur GCC.
+ */
+
+#include "tampon.h"
+
+/**
+ * Ajout de texte formaté à la fin du tampon, qui grandit si nécessaire.
+ * @param tampon Le tampon.
+ * @param format Le format, comme pour printf.
+ */
+void tamponAjouter(Tampon *tampon, const char *format, ...)
+{
+    if (tampon->taille == 0 && tampon->debutNs == 0)
+    {
+        tampon->debutNs = maintenantNs(); // Début d'une nouvelle image
+    }
+    va_list arguments;
+    while (1)
+    {
+        size_t libre = tampon->capacite - tampon->taille;
+        va_start(arguments, format);
+        int longueur = vsnprintf(tampon->donnees + tampon->taille, libre, format, arguments);
+        va_end(arguments);
+        if (longueur < 0)
+        {
+            return;
+        }
+        if ((size_t)longueur < libre) // Le texte tient dans le tampon
+        {
+            tampon->taille += longueur;
+            return;
+        }
+        // Sinon on agrandit le tampon et on recommence
+        size_t capacite = tampon->capacite == 0 ? 4096 : tampon->capacite * 2;
+        while (capacite - tampon->taille <= (size_t)longueur)
+        {
+            capacite *= 2;
+        }
+        char *donnees = realloc(tampon->donnees, capacite);
+        if (donnees == NULL)
+        {
+            perror("Erreur d'allocation mémoire pour le tampon d'affichage");
+            exit(EXIT_FAILURE);
+        }
+        tampon->donnees = donnees;
+        tampon->capacite = capacite;
+    }
+}
+
+/**
+ * Écriture de l'image composée dans le tampon en un seul appel, puis vidage du tampon.
+ * La taille et le temps de construction de l'image sont retenus dans le tampon.
+ * @param tampon Le tampon.
+ * @param flux Le flux dans lequel écrire.
+ */
+void tamponEnvoyer(Tampon *tampon, FILE *flux)
+{
+    tampon->dernierTempsNs = tampon->debutNs == 0 ? 0 : maintenantNs() - tampon->debutNs;
+    tampon->derniereTaille = tampon->taille;
+    fwrite(tampon->donnees, 1, tampon->taille, flux);
+    fflush(flux);
+    tampon->taille = 0;
+    tampon->debutNs = 0;
+}
+
+/**
+ * Libération de la mémoire du tampon.
+ * @param tampon Le tampon.
+ */
+void tamponLiberer(Tampon *tampon)
+{
+    free(tampon->donnees);
+    tampon->donnees = NULL;
+    tampon->taille = 0;
+    tampon->capacite = 0;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file tampon.h
+ * @brief Tampon de texte extensible, partagé par le moteur et l'affichage
+ *
+ * Le moteur y compose les messages des événements et les exports, l'affichage (affichage.c) ses images.
+ * Les fonctions sont définies dans tampon.c, compilé avec le moteur dans la bibliothèque labyrinthe :
+ * l'affichage les appelle sans inclure le moteur.
+ *
+ * Les structures principales incluent :
+ * - Tampon : Tampon extensible dans lequel on compose un texte complet avant de l'écrire.
+ *
+ * @note Utilisation du compilateur GCC.
+ */
+
+#ifndef TAMPON_H
+#define TAMPON_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+typedef struct Tampon // Tampon extensible dans lequel on compose une image complète avant de l'écrire
+{
+    char *donnees;         // Contenu de l'image en cours
+    size_t taille;         // Nombre d'octets écrits
+    size_t capacite;       // Nombre d'octets alloués
+    double debutNs;        // Instant où l'on a commencé à composer l'image en cours
+    size_t derniereTaille; // Taille de la dernière image écrite, en octets
+    double dernierTempsNs; // Temps de construction de la dernière image, en nanosecondes
+} Tampon;
+
+void tamponAjouter(Tampon *tampon, const char *format, ...);
+void tamponEnvoyer(Tampon *tampon, FILE *flux);
+void tamponLiberer(Tampon *tampon);
+
+#endif // TAMPON_H
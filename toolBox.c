@@ -4,25 +4,45 @@
  *
  * Ce fichier contient les définitions des fonctions utilitaires utilisées dans le jeu du labyrinthe.
  * Il inclut des fonctions pour initialiser et générer l'arbre binaire, réinitialiser les visites des nœuds,
- * afficher l'arbre de manière graphique, et gérer les événements du jeu.
+ * et gérer les événements du jeu. C'est le moteur de la bibliothèque labyrinthe (voir labyrinthe.c) :
+ * il ne lit pas le clavier et n'écrit pas sur le terminal, ce que fait l'affichage (affichage.c).
  *
  * Les fonctions principales incluent :
  * - init : Initialise un nouvel arbre binaire.
+ * - aleaInit : Initialise un générateur pseudo-aléatoire reproductible à partir d'une graine.
+ * - detruireArbre : Libère un arbre et tous ses nœuds.
  * - genererArbre : Génère un arbre binaire avec un nombre donné de nœuds.
- * - reinitialiserVisite : Réinitialise la visite de tous les nœuds de l'arbre.
- * - afficherArbre : Affiche l'arbre binaire de manière graphique.
- * - afficherArbreJoueur : Affiche l'arbre binaire avec la position actuelle du joueur.
- * - compterNoeudsNonExplores : Compte le nombre de nœuds non explorés dans l'arbre.
- * - afficherReglesDuJeu : Affiche les règles du jeu et les différents événements.
- * - boucleJeu : Boucle principale du jeu.
+ * - genererArbreCompact : Génère en temps linéaire un arbre compact de forme aléatoire uniforme.
+ * - genererArbreCompactParallele : Génère un très grand arbre compact sur tous les cœurs.
+ * - resoudreLabyrintheCompact : Cherche le plus court parcours jusqu'à la sortie, ou prouve qu'il n'y en a pas.
+ * - compacterArbre : Convertit l'arbre en représentation compacte (tableaux d'indices).
+ * - sauvegarderLabyrinthe / ouvrirLabyrinthe : Écrit un labyrinthe dans un fichier, le rouvre sans le recopier.
+ * - genererLabyrintheFichier : Génère un labyrinthe directement dans un fichier, en mémoire bornée.
+ * - exporterArbreCompact : Écrit un labyrinthe au format GraphViz (DOT) ou JSON lines.
+ * - initVisites / marquerVisiteJoueur : Visites d'un joueur, en table creuse puis en bitset selon ce qu'il a exploré.
+ * - afficherReleves / exporterReleves : Résumé et JSON des compteurs et temps relevés avec --stats.
+ * - jouerPartie : Joue un tour sur un arbre compact partagé entre plusieurs parties, avec ou sans messages.
+ * - rejouerJournal : Rejoue sans affichage le journal d'une partie et vérifie qu'elle finit dans le même état.
  *
  * @note Ce projet a été créé par Tony Evrard le 12/12/2024.
  * @note Utilisation du compilateur GCC.
  */
+#include <math.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
-#include <conio.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #include "toolBox.h"
 
@@ -39,7 +59,289 @@ Arbre *init()
         exit(EXIT_FAILURE);
     }
     arbre->premier = NULL; // Initialiser le premier nœud à NULL
-    return arbre;          // Retourner l'arbre initialisé
+    arbre->current = NULL;
+    arbre->arene = NULL; // Aucun bloc de nœuds pour le moment
+    arbre->nbNoeuds = 0;
+    arbre->nbNonExplores = 0;
+    arbre->epoque = 1; // L'époque 0 est réservée aux nœuds jamais visités
+    return arbre;      // Retourner l'arbre initialisé
+}
+
+/**
+ * Allocation d'un nouveau nœud dans l'arène de l'arbre.
+ * Les nœuds sont distribués depuis des blocs contigus, un nouveau bloc
+ * (deux fois plus grand que le précédent) n'est alloué que lorsque le bloc courant est plein.
+ * @param arbre L'arbre auquel appartient le nœud.
+ * @return le nouveau nœud, non initialisé.
+ */
+Element *allouerElement(Arbre *arbre)
+{
+    BlocArene *bloc = arbre->arene;
+    if (bloc == NULL || bloc->utilises == bloc->capacite) // Le bloc courant est plein
+    {
+        int capacite = bloc == NULL ? TAILLE_BLOC_ARENE : bloc->capacite * 2;
+        BlocArene *nouveau = malloc(sizeof(BlocArene) + capacite * sizeof(Element));
+        if (nouveau == NULL)
+        {
+            perror("Erreur d'allocation mémoire pour un nouveau noeud");
+            exit(EXIT_FAILURE);
+        }
+        nouveau->precedent = bloc;
+        nouveau->capacite = capacite;
+        nouveau->utilises = 0;
+        arbre->arene = nouveau;
+        bloc = nouveau;
+    }
+    return &bloc->elements[bloc->utilises++]; // On distribue le prochain nœud libre du bloc
+}
+
+/**
+ * Destruction de l'arbre binaire.
+ * Les nœuds étant regroupés dans les blocs de l'arène, on libère les blocs
+ * sans parcourir l'arbre (leur nombre ne croît qu'avec le logarithme du nombre de nœuds).
+ * @param arbre L'arbre à détruire.
+ */
+void detruireArbre(Arbre *arbre)
+{
+    if (arbre == NULL)
+    {
+        return;
+    }
+    BlocArene *bloc = arbre->arene;
+    while (bloc != NULL) // On libère chaque bloc de l'arène
+    {
+        BlocArene *precedent = bloc->precedent;
+        free(bloc);
+        bloc = precedent;
+    }
+    free(arbre);
+}
+
+/**
+ * Indique si un nœud a été visité depuis le dernier oubli des visites.
+ * @param arbre L'arbre auquel appartient le nœud.
+ * @param element Le nœud à tester.
+ * @return true si le nœud a été visité.
+ */
+static inline bool estVisite(const Arbre *arbre, const Element *element)
+{
+    return element->visite == arbre->epoque;
+}
+
+/**
+ * Étape du générateur splitmix64, utilisé seulement pour remplir l'état de xoshiro256** à partir d'une graine.
+ * @param etat L'état de splitmix64, mis à jour.
+ * @return 64 bits pseudo-aléatoires.
+ */
+static inline uint64_t splitmix64(uint64_t *etat)
+{
+    uint64_t z = (*etat += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Initialisation d'un générateur à partir d'une graine.
+ * La même graine donne la même suite de tirages sur toutes les machines, contrairement à rand().
+ * @param alea Le générateur.
+ * @param graine La graine.
+ */
+void aleaInit(Alea *alea, uint64_t graine)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        alea->s[i] = splitmix64(&graine); // Jamais quatre zéros de suite
+    }
+}
+
+static inline uint64_t rotationGauche(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * Tirage de 64 bits pseudo-aléatoires (xoshiro256**).
+ * Chaque générateur a son propre état : plusieurs threads peuvent tirer en même temps, chacun avec le sien.
+ * @param alea Le générateur, mis à jour.
+ * @return 64 bits pseudo-aléatoires.
+ */
+static inline uint64_t aleaSuivant(Alea *alea)
+{
+    uint64_t *s = alea->s;
+    uint64_t resultat = rotationGauche(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotationGauche(s[3], 45);
+    return resultat;
+}
+
+/**
+ * Tirage d'un entier entre 0 et borne - 1, sans biais et sans division dans le cas courant (méthode de Lemire) :
+ * on multiplie 32 bits aléatoires par la borne et on garde la partie haute, en refaisant le tirage
+ * dans les rares cas qui favoriseraient certaines valeurs (rand() % borne, lui, est toujours biaisé).
+ * @param alea Le générateur, mis à jour.
+ * @param borne Le nombre de valeurs possibles, au moins 1.
+ * @return l'entier tiré.
+ */
+static inline uint32_t aleaBorne(Alea *alea, uint32_t borne)
+{
+    uint64_t produit = (aleaSuivant(alea) >> 32) * borne;
+    uint32_t reste = (uint32_t)produit;
+    if (reste < borne)
+    {
+        uint32_t seuil = -borne % borne; // 2^32 mod borne
+        while (reste < seuil)
+        {
+            produit = (aleaSuivant(alea) >> 32) * borne;
+            reste = (uint32_t)produit;
+        }
+    }
+    return (uint32_t)(produit >> 32);
+}
+
+/**
+ * Saut de 2^128 tirages : appelé k fois sur une copie, il donne le k-ième d'une suite de flux
+ * qui ne se chevauchent jamais, un par thread ou par sous-arbre.
+ * @param alea Le générateur, avancé de 2^128 tirages.
+ */
+void aleaSaut(Alea *alea)
+{
+    static const uint64_t saut[4] = {0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull, 0xA9582618E03FC9AAull,
+                                     0x39ABDC4529B1661Cull};
+    uint64_t s[4] = {0, 0, 0, 0};
+    for (int i = 0; i < 4; i++)
+    {
+        for (int b = 0; b < 64; b++)
+        {
+            if (saut[i] & (1ull << b))
+            {
+                for (int k = 0; k < 4; k++)
+                {
+                    s[k] ^= alea->s[k];
+                }
+            }
+            aleaSuivant(alea);
+        }
+    }
+    memcpy(alea->s, s, sizeof(s));
+}
+
+/**
+ * Instant actuel en nanosecondes.
+ * @return le temps écoulé depuis une origine fixe.
+ */
+double maintenantNs()
+{
+    struct timespec t;
+    timespec_get(&t, TIME_UTC);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+static Releves releves = {0}; // Relevés du thread principal, faits seulement si le menu reçoit --stats
+
+// Nom de chaque temps relevé, dans l'ordre de Chrono
+static const char *nomsChronos[NB_CHRONOS] = {"generationArbre", "generationEvents", "generationFichier",
+                                               "attente", "logique", "affichage"};
+
+/**
+ * Début d'une mesure de temps pour les statistiques.
+ * @return l'instant actuel, 0 si les statistiques ne sont pas relevées (sans lire l'horloge).
+ */
+static inline double debutChrono()
+{
+    return releves.actives ? maintenantNs() : 0;
+}
+
+/**
+ * Fin d'une mesure de temps pour les statistiques.
+ * @param chrono Le temps mesuré.
+ * @param debutNs L'instant donné par debutChrono.
+ */
+static inline void finChrono(Chrono chrono, double debutNs)
+{
+    if (releves.actives)
+    {
+        double dureeNs = maintenantNs() - debutNs;
+        releves.mesures[chrono]++;
+        releves.totalNs[chrono] += dureeNs;
+        if (dureeNs > releves.maxNs[chrono])
+        {
+            releves.maxNs[chrono] = dureeNs;
+        }
+    }
+}
+
+/**
+ * Relevé d'une mise à jour du nombre de nœuds non explorés (visite d'un nouveau nœud, oubli, nouvelle partie).
+ */
+static inline void compterNonExplores()
+{
+    if (releves.actives)
+    {
+        releves.nonExploresMaj++;
+    }
+}
+
+/**
+ * Résumé lisible des statistiques relevées.
+ * @param flux Le flux où écrire le résumé.
+ */
+void afficherReleves(FILE *flux)
+{
+    fprintf(flux, "\n====== Statistiques ======\n");
+    for (int c = 0; c < NB_CHRONOS; c++)
+    {
+        uint64_t mesures = releves.mesures[c];
+        fprintf(flux, "%-17s : %llu mesure(s), total %.3f ms, moyenne %.1f us, max %.1f us\n", nomsChronos[c],
+                (unsigned long long)mesures, releves.totalNs[c] / 1e6,
+                mesures > 0 ? releves.totalNs[c] / mesures / 1000 : 0, releves.maxNs[c] / 1000);
+    }
+    fprintf(flux, "Tours de jeu : %llu (%llu touche(s))\n", (unsigned long long)releves.tours,
+            (unsigned long long)releves.touches);
+    fprintf(flux, "Visites : %llu oubli(s), %llu octet(s) efface(s), %llu mise(s) a jour des noeuds non explores\n",
+            (unsigned long long)releves.oublis, (unsigned long long)releves.octetsEffaces,
+            (unsigned long long)releves.nonExploresMaj);
+    fprintf(flux, "Images : %llu, %llu octet(s) ecrit(s) (moyenne %.1f, max %llu par image)\n",
+            (unsigned long long)releves.images, (unsigned long long)releves.octetsEcrits,
+            releves.images > 0 ? (double)releves.octetsEcrits / releves.images : 0,
+            (unsigned long long)releves.octetsMax);
+    fprintf(flux, "Evenements declenches :");
+    for (size_t j = 0; j < NB_TYPES_EVENTS; j++)
+    {
+        fprintf(flux, " %c %llu", eventTypes[j].letter, (unsigned long long)releves.declenchements[j]);
+    }
+    fprintf(flux, "\n");
+}
+
+/**
+ * Écriture des statistiques relevées sur une ligne JSON, pour les comparer d'une session à l'autre.
+ * @param flux Le flux où écrire la ligne.
+ */
+void exporterReleves(FILE *flux)
+{
+    fprintf(flux, "{\"chronos\":{");
+    for (int c = 0; c < NB_CHRONOS; c++)
+    {
+        fprintf(flux, "%s\"%s\":{\"mesures\":%llu,\"total_ns\":%.0f,\"max_ns\":%.0f}", c > 0 ? "," : "", nomsChronos[c],
+                (unsigned long long)releves.mesures[c], releves.totalNs[c], releves.maxNs[c]);
+    }
+    fprintf(flux, "},\"tours\":%llu,\"touches\":%llu,\"oublis\":%llu,\"octets_effaces\":%llu,\"maj_non_explores\":%llu,"
+                  "\"images\":%llu,\"octets_ecrits\":%llu,\"octets_max\":%llu,\"declenchements\":{",
+            (unsigned long long)releves.tours, (unsigned long long)releves.touches, (unsigned long long)releves.oublis,
+            (unsigned long long)releves.octetsEffaces, (unsigned long long)releves.nonExploresMaj,
+            (unsigned long long)releves.images, (unsigned long long)releves.octetsEcrits,
+            (unsigned long long)releves.octetsMax);
+    for (size_t j = 0; j < NB_TYPES_EVENTS; j++)
+    {
+        fprintf(flux, "%s\"%c\":%llu", j > 0 ? "," : "", eventTypes[j].letter,
+                (unsigned long long)releves.declenchements[j]);
+    }
+    fprintf(flux, "}}\n");
 }
 
 /**
@@ -47,24 +349,22 @@ Arbre *init()
  * De façon aléatoire. Avec un nombre de nœuds donné.
  * @param arbre L'arbre binaire à générer.
  * @param nombre Le nombre de nœuds à générer.
+ * @param alea Le générateur pseudo-aléatoire.
  */
-void genererArbre(Arbre *arbre, int nombre)
+void genererArbre(Arbre *arbre, int nombre, Alea *alea)
 {
+    double debutNs = debutChrono();
     if (arbre->premier == NULL) // Si l'arbre est vide
     {
-        Element *nouveau = malloc(sizeof(Element)); // Allouer de la mémoire pour un nouveau nœud
-        if (nouveau == NULL)                        // Vérifier si l'allocation a réussi
-        {
-            perror("Erreur d'allocation mémoire pour un nouveau noeud");
-            exit(EXIT_FAILURE);
-        }
+        Element *nouveau = allouerElement(arbre); // Prendre un nouveau nœud dans l'arène
         nouveau->suivantG = NULL; // Initialiser les pointeurs à NULL
         nouveau->suivantD = NULL;
         nouveau->parent = NULL;
         nouveau->event = 'E';     // Initialiser l'événement à l'entrée
-        nouveau->visite = true;   // Marquer l'entrée comme visitée
+        nouveau->visite = arbre->epoque; // Marquer l'entrée comme visitée
         arbre->premier = nouveau; // Affecter le premier nœud de l'arbre
-        nombre--;                 // Décrémenter le nombre de nœuds restants
+        arbre->nbNoeuds++;
+        nombre--; // Décrémenter le nombre de nœuds restants
     }
 
     for (int i = 0; i < nombre; i++) // Pour chaque nœud restant à générer
@@ -73,22 +373,19 @@ void genererArbre(Arbre *arbre, int nombre)
         while (1)
         {
             // Choisir un enfant aléatoire
-            if (rand() % 2 == 0)
+            if (aleaBorne(alea, 2) == 0)
             {
                 if (current->suivantG == NULL) // On vérifie si le nœud gauche est vide
                 {
-                    Element *nouveau = malloc(sizeof(Element));
-                    if (nouveau == NULL)
-                    {
-                        perror("Erreur d'allocation mémoire pour un nouveau noeud");
-                        exit(EXIT_FAILURE);
-                    }
+                    Element *nouveau = allouerElement(arbre);
                     nouveau->suivantG = NULL;
                     nouveau->suivantD = NULL;
                     nouveau->parent = current;
                     nouveau->event = 'X';        // Nœud standard pour le moment
-                    nouveau->visite = false;     // Nœud non visité
+                    nouveau->visite = 0;         // Nœud non visité
                     current->suivantG = nouveau; // Affecter le nouveau nœud comme enfant gauche
+                    arbre->nbNoeuds++;
+                    arbre->nbNonExplores++;
                     break;
                 }
                 current = current->suivantG; // Passer à l'enfant gauche
@@ -97,18 +394,15 @@ void genererArbre(Arbre *arbre, int nombre)
             {
                 if (current->suivantD == NULL)
                 {
-                    Element *nouveau = malloc(sizeof(Element));
-                    if (nouveau == NULL)
-                    {
-                        perror("Erreur d'allocation mémoire pour un nouveau noeud");
-                        exit(EXIT_FAILURE);
-                    }
+                    Element *nouveau = allouerElement(arbre);
                     nouveau->suivantG = NULL;
                     nouveau->suivantD = NULL;
                     nouveau->parent = current;
                     nouveau->event = 'X';
-                    nouveau->visite = false;
+                    nouveau->visite = 0;
                     current->suivantD = nouveau;
+                    arbre->nbNoeuds++;
+                    arbre->nbNonExplores++;
                     break;
                 }
                 current = current->suivantD;
@@ -120,7 +414,7 @@ void genererArbre(Arbre *arbre, int nombre)
     Element *current = arbre->premier;
     while (current->suivantG != NULL || current->suivantD != NULL) // Trouver une feuille
     {
-        if (current->suivantG != NULL && (current->suivantD == NULL || rand() % 2 == 0)) // Si le nœud gauche existe et le droit n'existe pas ou aléatoirement
+        if (current->suivantG != NULL && (current->suivantD == NULL || aleaBorne(alea, 2) == 0)) // Si le nœud gauche existe et le droit n'existe pas ou aléatoirement
         {
             current = current->suivantG;
         }
@@ -130,628 +424,3215 @@ void genererArbre(Arbre *arbre, int nombre)
         }
     }
     current->event = 'S'; // Affecter la sortie à la feuille
+    finChrono(CHRONO_GENERER_ARBRE, debutNs);
 }
 
 /**
- * Comptage du nombre d'éléments dans l'arbre.
- * @param element L'élément à compter.
- * @return Nombre d'éléments dans l'arbre.
+ * Nœud suivant dans un parcours préfixe du sous-arbre, sans pile ni récursion.
+ * On descend à gauche, sinon à droite, sinon on remonte par les pointeurs parent
+ * jusqu'à un ancêtre dont on sort du sous-arbre gauche et qui a un fils droit.
+ * @param element Le nœud courant du parcours.
+ * @param racine La racine du sous-arbre parcouru (on ne remonte jamais au-dessus).
+ * @param profondeur Profondeur du nœud courant, mise à jour pour le nœud renvoyé (peut être NULL).
+ * @return le nœud suivant, ou NULL si le parcours est terminé.
  */
-int nombreElement(Element *element)
+static Element *suivantPrefixe(Element *element, Element *racine, int *profondeur)
 {
-    // Fonction récursive pour compter les éléments
-    if (element == NULL)
+    int delta = 1;
+    Element *suivant = NULL;
+    if (element->suivantG != NULL)
     {
-        return 0;
+        suivant = element->suivantG;
     }
-    return 1 + nombreElement(element->suivantG) + nombreElement(element->suivantD); // Compter l'élément actuel et ses enfants et on retourne le total
-}
-
-/**
- * Compte le nombre de nœuds non explorés dans l'arbre.
- * @param element L'élément à partir duquel commencer le comptage.
- * @return Nombre de nœuds non explorés.
- */
-int compterNoeudsNonExplores(Element *element)
-{
-    // fonction récursive pour compter les nœuds non explorés
-    if (element == NULL)
+    else if (element->suivantD != NULL)
     {
-        return 0;
+        suivant = element->suivantD;
     }
-    int count = element->visite ? 0 : 1;                                                                      // Si le nœud est visité, on ne le compte pas
-    return count + compterNoeudsNonExplores(element->suivantG) + compterNoeudsNonExplores(element->suivantD); // On compte le nœud actuel et ses enfants et on retourne le total
-}
-
-/**
- * Collecte tous les nœuds de l'arbre.
- * @param element L'élément à partir duquel commencer la collecte.
- * @param noeud Tableau de nœuds à remplir.
- * @param nbNoeuds Nombre de nœuds collectés.
- */
-void collecteNoeuds(Element *element, Element **noeud, int *nbNoeuds)
-{
-    if (element == NULL)
-        return; // Si l'élément est NULL, on ne fait rien
-    if (element->event != 'E' && element->event != 'S')
-    {                                   // On ne collecte pas les entrées et les sorties
-        noeud[(*nbNoeuds)++] = element; // On ajoute le nœud au tableau
+    else
+    {
+        while (element != racine)
+        {
+            Element *parent = element->parent;
+            delta--;
+            if (element == parent->suivantG && parent->suivantD != NULL)
+            {
+                suivant = parent->suivantD;
+                break;
+            }
+            element = parent;
+        }
+    }
+    if (profondeur != NULL)
+    {
+        *profondeur += delta;
     }
-    collecteNoeuds(element->suivantG, noeud, nbNoeuds); // On continue la collecte avec les enfants
-    collecteNoeuds(element->suivantD, noeud, nbNoeuds);
+    return suivant;
 }
 
 /**
- * Trouver un chemin dans l'arbre.
- * @param noeud Le nœud à partir duquel commencer la recherche.
- * @param cheminNoeuds Tableau de nœuds à remplir.
- * @param longueurChemin Longueur du chemin.
+ * Comptage du nombre d'éléments dans l'arbre.
+ * @param element L'élément à compter.
+ * @return Nombre d'éléments dans l'arbre.
  */
-void chercherChemin(Element *noeud, Element **cheminNoeuds, int *longueurChemin)
+int nombreElement(Element *element)
 {
-    if (noeud == NULL)
-        return; // Si le nœud est NULL, on ne fait rien
-
-    cheminNoeuds[(*longueurChemin)++] = noeud; // On ajoute le nœud au chemin
-
-    if (noeud->suivantG != NULL)
-    { // Si le nœud a un enfant gauche, on continue la recherche
-        chercherChemin(noeud->suivantG, cheminNoeuds, longueurChemin);
-    }
-    else if (noeud->suivantD != NULL)
-    { // Si le nœud a un enfant droit, on continue la recherche
-        chercherChemin(noeud->suivantD, cheminNoeuds, longueurChemin);
+    // Parcours itératif, pour supporter les arbres très profonds
+    int total = 0;
+    for (Element *noeud = element; noeud != NULL; noeud = suivantPrefixe(noeud, element, NULL))
+    {
+        total++;
     }
-    // Si c'est une feuille, ne fait rien
+    return total;
 }
 
 /**
- * Génération des événements pour chaque nœud de l'arbre.
- * @param arbre L'arbre binaire à parcourir.
+ * Reconstruction de la table d'alias avec les types encore tirables (méthode de Vose).
+ * Un type est tirable si son poids est positif, si son quota n'est pas épuisé et, quand il ne reste
+ * que les nœuds nécessaires aux minimums, s'il lui manque encore des occurrences.
+ * Coûte O(nombre de types), seulement quand un quota change l'ensemble des types tirables.
+ * @param tirage Le tirage à reconstruire.
  */
-void genererEvents(Arbre *arbre)
+static void construireTirageEvents(TirageEvents *tirage)
 {
-    // Initialise les compteurs d'événements
-    int eventCounts[128] = {0};                               // Pour les 128 caractères ASCII au cas où
-    int totalEvents = sizeof(eventTypes) / sizeof(EventType); // Nombre total d'événements enregistrés
-
-    // Extrait les événements déjà placés
-    eventCounts['E'] = 1;
-    eventCounts['S'] = 1;
-
-    // Flags pour vérifier si la clé et la porte ont été placées
-    bool keyOK = false;
-    bool doorOK = false;
-
-    // Collecte tous les nœuds de l'arbre
-    int maxNoeuds = nombreElement(arbre->premier); // Nombre maximum de nœuds
-    Element **nodes = malloc(maxNoeuds * sizeof(Element *));
-    if (nodes == NULL)
-    {
-        perror("Erreur d'allocation mémoire pour les nœuds");
-        exit(EXIT_FAILURE);
-    }
-    int nbNoeuds = 0;
-    collecteNoeuds(arbre->premier, nodes, &nbNoeuds); // Collecte les nœuds
-
-    // Assigne 'K' et 'D' à des nœuds aléatoires
-    Element *pathNodes[maxNoeuds];
-    int longueurChemin = 0;
-    chercherChemin(arbre->premier, pathNodes, &longueurChemin);
-
-    Element *keyNode = NULL;
-
-    if (longueurChemin >= 3)
-    {
-        // on s'assure de placer la clé et la porte entre l'entrée et la sortie
-        int keyStartIndex = 1;                // On commence après l'entrée
-        int keyEndIndex = longueurChemin - 2; // Et on finit avant la sortie
-
-        if (keyStartIndex <= keyEndIndex)
-        {
-            // On place 'K' à un nœud aléatoire entre l'entrée et la sortie
-            int keyIndex = keyStartIndex + rand() % (keyEndIndex - keyStartIndex + 1);
-            keyNode = pathNodes[keyIndex];
-            keyNode->event = 'K';
-            keyOK = true;
-            eventCounts['K']++;
-
-            // On place 'D' à un nœud plus profond que la clé
-            Element **deeperNodes = malloc(maxNoeuds * sizeof(Element *));
-            if (deeperNodes == NULL)
-            {
-                perror("Erreur d'allocation mémoire pour les nœuds plus profonds");
-                free(nodes);
-                exit(EXIT_FAILURE);
-            }
-            int deeperNodeCount = 0;
-            // On collecte les nœuds plus profonds que la clé
-            for (int i = 0; i < nbNoeuds; i++)
-            {
-                if (nodes[i] != keyNode && nodes[i]->parent != NULL)
-                {
-                    int depth = 0;
-                    Element *temp = nodes[i];
-                    while (temp != NULL)
-                    {
-                        depth++;
-                        temp = temp->parent;
-                    }
-                    if (depth > keyIndex)
-                    {
-                        deeperNodes[deeperNodeCount++] = nodes[i];
-                    }
-                }
-            }
-
-            // On place 'D' à un nœud aléatoire parmi les nœuds plus profonds que la clé
-            if (deeperNodeCount > 0)
-            {
-                int doorIndex = rand() % deeperNodeCount;
-                Element *doorNode = deeperNodes[doorIndex];
-                doorNode->event = 'D';
-                doorOK = true;
-                eventCounts['D']++;
-            }
-
-            free(deeperNodes);
-        }
-    }
-
-    // On retire les nœuds avec 'K' et 'D' de la liste
-    for (int i = 0; i < nbNoeuds; i++)
+    double poids[NB_TYPES_EVENTS]; // Poids ramenés à une moyenne de 1 par colonne
+    double total = 0;
+    tirage->nbColonnes = 0;
+    for (uint32_t j = 0; j < NB_TYPES_EVENTS; j++)
     {
-        if (nodes[i]->event == 'K' || nodes[i]->event == 'D')
+        if (eventTypes[j].poids > 0 && tirage->restants[j] != 0 && (!tirage->force || tirage->manquants[j] > 0))
         {
-            nodes[i] = nodes[nbNoeuds - 1];
-            nbNoeuds--;
-            i--;
+            tirage->types[tirage->nbColonnes] = (uint8_t)j;
+            poids[tirage->nbColonnes++] = eventTypes[j].poids;
+            total += eventTypes[j].poids;
         }
     }
 
-    // On mélange les nœuds
-    for (int i = nbNoeuds - 1; i > 0; i--)
+    // Colonnes sous la moyenne (petites) et au-dessus (grandes)
+    uint8_t petites[NB_TYPES_EVENTS], grandes[NB_TYPES_EVENTS];
+    uint32_t nbPetites = 0, nbGrandes = 0;
+    for (uint32_t c = 0; c < tirage->nbColonnes; c++)
     {
-        int j = rand() % (i + 1);
-        Element *temp = nodes[i];
-        nodes[i] = nodes[j];
-        nodes[j] = temp;
+        poids[c] = poids[c] * tirage->nbColonnes / total;
+        if (poids[c] < 1.0)
+            petites[nbPetites++] = (uint8_t)c;
+        else
+            grandes[nbGrandes++] = (uint8_t)c;
     }
 
-    // On assigne les événements restants
-    for (int i = 0; i < nbNoeuds; i++)
+    // Chaque petite colonne est complétée par une grande, qui perd d'autant
+    while (nbPetites > 0 && nbGrandes > 0)
     {
-        Element *node = nodes[i];
-
-        // Liste des événements possibles
-        char possibleEvents[128];
-        int possibleCount = 0;
-        for (int j = 0; j < totalEvents; j++)
-        {
-            char eventLetter = eventTypes[j].letter;
-            int maxOccur = eventTypes[j].maxOccurrences;
-
-            // Exclusion de 'E', 'S', 'K', 'D'
-            if (eventLetter == 'E' || eventLetter == 'S' || eventLetter == 'K' || eventLetter == 'D')
-                continue;
-
-            if (maxOccur == -1 || eventCounts[(int)eventLetter] < maxOccur)
-            {
-                possibleEvents[possibleCount++] = eventLetter;
-            }
-        }
-
-        // On choisit un événement aléatoire parmi les événements possibles
-        if (possibleCount > 0)
-        {
-            char event = possibleEvents[rand() % possibleCount];
-            node->event = event;
-            eventCounts[(int)event]++;
-        }
-        else
+        uint8_t petite = petites[--nbPetites];
+        uint8_t grande = grandes[nbGrandes - 1];
+        tirage->seuils[petite] = (uint64_t)(poids[petite] * 4294967296.0);
+        tirage->alias[petite] = grande;
+        poids[grande] -= 1.0 - poids[petite];
+        if (poids[grande] < 1.0)
         {
-            node->event = 'X'; // Noeud standard
+            nbGrandes--;
+            petites[nbPetites++] = grande;
         }
     }
 
-    free(nodes); // Libère la mémoire allouée pour les nœuds collectés
-
-    // On vérifie que la clé et la porte ont été placées
-    if (keyOK && !doorOK)
+    // Les colonnes restantes sont pleines, aux erreurs d'arrondi près
+    while (nbGrandes > 0)
     {
-        printf("Avertissement: Clé générée mais pas de porte. La clé redevient un noeud standard.\n");
-        if (keyNode != NULL)
-        {
-            keyNode->event = 'X';
-        }
+        uint8_t c = grandes[--nbGrandes];
+        tirage->seuils[c] = UINT64_C(1) << 32;
+        tirage->alias[c] = c;
     }
-
-    if (doorOK && !keyOK)
+    while (nbPetites > 0)
     {
-        printf("Avertissement: Porte générée mais pas de clé.\n");
+        uint8_t c = petites[--nbPetites];
+        tirage->seuils[c] = UINT64_C(1) << 32;
+        tirage->alias[c] = c;
     }
 }
 
 /**
- * Réinitialisation de la visite de tous les nœuds de l'arbre.
- * @param element L'élément à réinitialiser.
+ * Initialisation du tirage des événements à partir des poids et des quotas de eventTypes.
+ * @param tirage Le tirage à initialiser.
  */
-void reinitialiserVisite(Element *element)
+void initTirageEvents(TirageEvents *tirage)
 {
-    // Fonction récursive pour réinitialiser la visite de tous les nœuds
-    if (element == NULL)
+    tirage->totalManquants = 0;
+    tirage->force = false;
+    for (uint32_t j = 0; j < NB_TYPES_EVENTS; j++)
     {
-        return;
+        tirage->restants[j] = eventTypes[j].maxOccurrences;
+        tirage->manquants[j] = eventTypes[j].poids > 0 ? eventTypes[j].minOccurrences : 0;
+        tirage->totalManquants += tirage->manquants[j];
     }
-    element->visite = false;
-    reinitialiserVisite(element->suivantG); // Réinitialiser les enfants
-    reinitialiserVisite(element->suivantD);
+    construireTirageEvents(tirage);
 }
 
 /**
- * Affichage de l'arbre binaire de façon graphique pour le débogage.
- * @param element L'élément à afficher.
- * @param profondeur La profondeur de l'élément.
- * @param current L'élément actuel.
+ * Tirage pondéré d'un événement en temps constant : une colonne au hasard, puis elle-même ou son alias.
+ * Un seul nombre de 64 bits suffit : les 32 bits de poids fort choisissent la colonne, les 32 autres
+ * la comparent à son seuil. Le maximum d'un type n'est jamais dépassé, et son minimum est atteint
+ * dès que l'arbre a assez de nœuds.
+ * @param tirage Le tirage, mis à jour.
+ * @param nbRestants Nombre de nœuds restant à assigner, celui-ci compris.
+ * @param alea Le générateur pseudo-aléatoire.
+ * @return la lettre de l'événement choisi ('X' si aucun n'est disponible).
  */
-void afficherArbre(Element *element, int profondeur, Element *current)
+char tirerEvent(TirageEvents *tirage, uint64_t nbRestants, Alea *alea)
 {
-    // Indentation pour la profondeur
-    for (int i = 0; i < profondeur; i++)
+    // S'il ne reste que les nœuds nécessaires aux minimums, on ne tire plus que les types qui en manquent
+    if (!tirage->force && tirage->totalManquants > 0 && tirage->totalManquants >= nbRestants)
     {
-        printf("|   ");
+        tirage->force = true;
+        construireTirageEvents(tirage);
     }
-    if (element == NULL)
+    if (tirage->nbColonnes == 0)
     {
-        printf("|-- NULL\n");
-        return;
+        return 'X'; // Noeud standard
     }
-    if (element == current)
+
+    uint64_t tirageBrut = aleaSuivant(alea);
+    uint32_t colonne = (uint32_t)(((tirageBrut >> 32) * tirage->nbColonnes) >> 32);
+    if ((tirageBrut & 0xFFFFFFFF) >= tirage->seuils[colonne])
     {
-        if (element->visite)
-        {
-            printf("|-- %c " RED "<- Vous etes ici" RESET "\n", element->event);
-        }
-        else
-        {
-            printf("|-- ? " RED "<- Vous etes ici" RESET "\n");
-        }
+        colonne = tirage->alias[colonne];
     }
-    else if (element == current->parent)
+    uint8_t type = tirage->types[colonne];
+
+    // Mise à jour des quotas, la table n'est reconstruite que si l'ensemble des types tirables change
+    bool reconstruire = false;
+    if (tirage->restants[type] > 0 && --tirage->restants[type] == 0)
     {
-        if (element->visite)
-        {
-            printf("|-- %c " GREEN "<- Parent" RESET "\n", element->event);
-        }
-        else
-        {
-            printf("|-- ? " GREEN "<- Parent" RESET "\n");
-        }
+        reconstruire = true;
     }
-    else if (element == current->suivantG)
+    if (tirage->manquants[type] > 0)
     {
-        if (element->visite)
+        tirage->totalManquants--;
+        if (--tirage->manquants[type] == 0 && tirage->force)
         {
-            printf("|-- %c " GREEN "<- Gauche" RESET "\n", element->event);
+            reconstruire = true;
         }
-        else
+    }
+    if (reconstruire)
+    {
+        construireTirageEvents(tirage);
+    }
+    return eventTypes[type].letter;
+}
+
+/**
+ * Type tirable sans quota (ni maximum, ni minimum manquant), dont les tirages ne changent pas la table.
+ * @param tirage Le tirage.
+ * @param part Part du poids des types tirables qui revient à ce type.
+ * @return l'indice du type dans eventTypes, -1 s'il n'y a pas exactement un tel type.
+ */
+static int typeSansQuota(const TirageEvents *tirage, double *part)
+{
+    int libre = -1;
+    int nbLibres = 0;
+    double total = 0;
+    for (uint32_t c = 0; c < tirage->nbColonnes; c++)
+    {
+        uint8_t j = tirage->types[c];
+        total += eventTypes[j].poids;
+        if (tirage->restants[j] < 0 && tirage->manquants[j] == 0)
         {
-            printf("|-- ? " GREEN "<- Gauche" RESET "\n");
+            libre = j;
+            nbLibres++;
         }
     }
-    else if (element == current->suivantD)
+    if (nbLibres != 1)
+    {
+        return -1;
+    }
+    *part = eventTypes[libre].poids / total;
+    return libre;
+}
+
+/**
+ * Nombre d'occurrences de chaque type d'événement pour nbNoeuds nœuds, avec la même loi que tirerEvents,
+ * pour les générateurs qui placent eux-mêmes les événements sans tirer une lettre par nœud.
+ * Tant qu'un seul type tirable est sans quota (le nœud standard 'X'), la série de ses tirages avant
+ * celui d'un autre type suit une loi géométrique : elle est tirée d'un coup, et le coût ne dépend que
+ * du nombre d'événements à quota.
+ * @param nombres Nombre d'occurrences de chaque type, dans l'ordre de eventTypes, à remplir.
+ * @param nbNoeuds Le nombre de nœuds.
+ * @param alea Le générateur pseudo-aléatoire.
+ */
+void tirerNombresEvents(uint64_t nombres[NB_TYPES_EVENTS], uint64_t nbNoeuds, Alea *alea)
+{
+    TirageEvents tirage;
+    initTirageEvents(&tirage);
+    memset(nombres, 0, NB_TYPES_EVENTS * sizeof(uint64_t));
+    uint64_t i = 0;
+    while (i < nbNoeuds)
     {
-        if (element->visite)
+        uint64_t nbRestants = nbNoeuds - i;
+        // Tirages possibles avant que les minimums imposent leurs types
+        uint64_t avantForce = tirage.totalManquants < nbRestants ? nbRestants - tirage.totalManquants : 0;
+        double part;
+        int libre = tirage.force ? -1 : typeSansQuota(&tirage, &part);
+        if (libre < 0 || avantForce == 0)
         {
-            printf("|-- %c " GREEN "<- Droite" RESET "\n", element->event);
+            nombres[indiceEvent[(unsigned char)tirerEvent(&tirage, nbRestants, alea)]]++;
+            i++;
+            continue;
         }
-        else
+        uint64_t serie = avantForce;
+        if (part < 1.0)
         {
-            printf("|-- ? " GREEN "<- Droite" RESET "\n");
+            double u = ((aleaSuivant(alea) >> 11) + 1) * 0x1.0p-53; // Uniforme dans ]0, 1]
+            double longueur = floor(log(u) / log(part));
+            if (longueur < (double)avantForce)
+            {
+                serie = (uint64_t)longueur;
+            }
         }
-    }
-    else
-    {
-        if (element->visite)
+        nombres[libre] += serie;
+        i += serie;
+        if (serie == avantForce)
         {
-            printf("|-- %c\n", element->event);
+            continue;
         }
-        else
+        // Le tirage suivant est d'un autre type : tirer le type libre ne change pas la table, on le rejette
+        char event;
+        do
         {
-            printf("|-- ?\n");
-        }
+            event = tirerEvent(&tirage, nbNoeuds - i, alea);
+        } while (indiceEvent[(unsigned char)event] == libre);
+        nombres[indiceEvent[(unsigned char)event]]++;
+        i++;
     }
-
-    // On affiche les sous-arbres en commençant par le sous-arbre gauche
-    afficherArbre(element->suivantG, profondeur + 1, current);
-
-    // puis le droit
-    afficherArbre(element->suivantD, profondeur + 1, current);
 }
 
 /**
- * Affichage de l'arbre binaire de façon graphique pour le joueur.
- * @param arbre L'arbre binaire à afficher.
+ * Tirage des événements de nbNoeuds nœuds, dans un ordre uniformément aléatoire.
+ * Les événements sont tirés à la suite, ce qui rend les premiers plus probables pour les types à quota,
+ * puis mélangés : chaque nœud a alors la même loi. Le mélange porte sur des octets consécutifs,
+ * bien moins coûteux que de mélanger les nœuds eux-mêmes.
+ * @param events Tableau de nbNoeuds lettres à remplir.
+ * @param nbNoeuds Le nombre de nœuds.
+ * @param alea Le générateur pseudo-aléatoire.
  */
-void afficherArbreJoueur(Arbre *arbre)
+void tirerEvents(char *events, uint32_t nbNoeuds, Alea *alea)
 {
-    Element *current = arbre->current;
-    printf("\n=============================\n\n");
-
-    // Afficher le parent s'il existe
-    if (current->parent != NULL)
+    TirageEvents tirage;
+    initTirageEvents(&tirage);
+    for (uint32_t i = 0; i < nbNoeuds; i++)
+    {
+        events[i] = tirerEvent(&tirage, nbNoeuds - i, alea);
+    }
+    for (uint32_t i = nbNoeuds; i > 1; i--)
     {
-        current->parent->visite ? printf("          [%c]\n", current->parent->event) : printf("          [?]\n");
-        printf("           |\n");
+        uint32_t j = aleaBorne(alea, i);
+        char temp = events[i - 1];
+        events[i - 1] = events[j];
+        events[j] = temp;
     }
+}
 
-    // Afficher le nœud actuel
-    current->visite ? printf("          [%c] <- Vous etes ici\n", current->event) : printf("          [?] <- Vous etes ici\n");
-    printf("         /   \\\n");
+#include "tampon.c"
 
-    // Afficher les enfants
-    if (current->suivantG != NULL)
-    {
-        current->suivantG->visite ? printf("      [%c]     ", current->suivantG->event) : printf("      [?]     ");
-        if (current->suivantD != NULL)
-        {
-            current->suivantD->visite ? printf("[%c]\n", current->suivantD->event) : printf("[?]\n");
+/**
+ * Recherche du plus court parcours de l'entrée à la sortie, d'un point remarquable à l'autre.
+ * Entre deux points remarquables, le joueur suit le chemin de l'arbre ; l'état de la partie
+ * (clé, salles U et R pas encore visitées) ne change qu'en arrivant sur l'un d'eux.
+ * On cherche donc un plus court chemin (Dijkstra) dans le graphe des couples (point, état),
+ * qui a au plus NB_POINTS * NB_ETATS sommets : la recherche est exhaustive, une absence de solution est prouvée.
+ * @param trajets Les trajets entre points remarquables, trajets[depart][arrivee].
+ * @param etatInitial L'état de la partie à l'entrée.
+ * @param etapes Rempli avec les couples (départ, arrivée) des trajets à suivre, dans l'ordre.
+ * @param nbEtapes Le nombre de trajets à suivre.
+ * @return le nombre total de mouvements, -1 si la sortie est inaccessible.
+ */
+static int chercherParcours(Trajet trajets[NB_POINTS][NB_POINTS], int etatInitial, int etapes[][2], int *nbEtapes)
+{
+    int distance[NB_POINTS][NB_ETATS];
+    int precedent[NB_POINTS][NB_ETATS][3]; // Point et état de départ, point visé du trajet qui y mène
+    bool fini[NB_POINTS][NB_ETATS] = {0};
+    for (int p = 0; p < NB_POINTS; p++)
+    {
+        for (int e = 0; e < NB_ETATS; e++)
+        {
+            distance[p][e] = -1;
+        }
+    }
+    distance[POINT_ENTREE][etatInitial] = 0;
+    int meilleure = -1, etatFinal = 0;
+
+    while (1)
+    {
+        // Couple non traité le plus proche
+        int point = -1, etat = 0;
+        for (int p = 0; p < NB_POINTS; p++)
+        {
+            for (int e = 0; e < NB_ETATS; e++)
+            {
+                if (!fini[p][e] && distance[p][e] >= 0 && (point < 0 || distance[p][e] < distance[point][etat]))
+                {
+                    point = p;
+                    etat = e;
+                }
+            }
+        }
+        if (point < 0 || (meilleure >= 0 && distance[point][etat] >= meilleure))
+        {
+            break; // Plus rien à explorer, ou plus rien qui puisse faire mieux
+        }
+        fini[point][etat] = true;
+
+        // Points qui se déclenchent si on les traverse dans cet état : le trajet doit s'y arrêter
+        int declencheurs = 1 << POINT_SORTIE;
+        if (!(etat & ETAT_CLE))
+            declencheurs |= 1 << POINT_CLE;
+        if (etat & ETAT_CHUTE)
+            declencheurs |= 1 << POINT_CHUTE;
+        if (etat & ETAT_OUBLI)
+            declencheurs |= 1 << POINT_OUBLI;
+
+        for (int cible = 0; cible < NB_POINTS; cible++)
+        {
+            Trajet *trajet = &trajets[point][cible];
+            if (cible == point || trajet->longueur < 0 || (trajet->traverses & declencheurs) ||
+                (trajet->porteFermee && !(etat & ETAT_CLE)))
+            {
+                continue;
+            }
+            int d = distance[point][etat] + trajet->longueur;
+            if (cible == POINT_SORTIE)
+            {
+                if (meilleure < 0 || d < meilleure)
+                {
+                    meilleure = d;
+                    etatFinal = etat;
+                    precedent[POINT_SORTIE][etat][0] = point;
+                    precedent[POINT_SORTIE][etat][1] = etat;
+                    precedent[POINT_SORTIE][etat][2] = cible;
+                }
+                continue;
+            }
+            // Événements de la salle d'arrivée, dans l'ordre de entrerSallePartie
+            int arrivee = cible, nouvelEtat = etat;
+            if (cible == POINT_OUBLI && (etat & ETAT_OUBLI))
+            {
+                nouvelEtat &= ~ETAT_OUBLI;
+                if (trajets[POINT_ENTREE][POINT_CHUTE].longueur >= 0)
+                {
+                    nouvelEtat |= ETAT_CHUTE; // La salle U est oubliée, elle fera de nouveau tomber
+                }
+            }
+            if (cible == POINT_CHUTE && (etat & ETAT_CHUTE))
+            {
+                nouvelEtat &= ~ETAT_CHUTE;
+                arrivee = POINT_ENTREE;
+            }
+            if (cible == POINT_CLE)
+            {
+                nouvelEtat |= ETAT_CLE;
+            }
+            if (!fini[arrivee][nouvelEtat] && (distance[arrivee][nouvelEtat] < 0 || d < distance[arrivee][nouvelEtat]))
+            {
+                distance[arrivee][nouvelEtat] = d;
+                precedent[arrivee][nouvelEtat][0] = point;
+                precedent[arrivee][nouvelEtat][1] = etat;
+                precedent[arrivee][nouvelEtat][2] = cible;
+            }
+        }
+    }
+
+    *nbEtapes = 0;
+    if (meilleure < 0)
+    {
+        return -1;
+    }
+    // On remonte les trajets depuis la sortie, puis on les remet dans l'ordre
+    int point = POINT_SORTIE, etat = etatFinal;
+    while (point != POINT_ENTREE || etat != etatInitial || *nbEtapes == 0)
+    {
+        int *avant = precedent[point][etat];
+        etapes[*nbEtapes][0] = avant[0];
+        etapes[*nbEtapes][1] = avant[2];
+        (*nbEtapes)++;
+        point = avant[0];
+        etat = avant[1];
+    }
+    for (int i = 0; i < *nbEtapes / 2; i++)
+    {
+        int depart = etapes[i][0], arrivee = etapes[i][1];
+        etapes[i][0] = etapes[*nbEtapes - 1 - i][0];
+        etapes[i][1] = etapes[*nbEtapes - 1 - i][1];
+        etapes[*nbEtapes - 1 - i][0] = depart;
+        etapes[*nbEtapes - 1 - i][1] = arrivee;
+    }
+    return meilleure;
+}
+
+/**
+ * Raison de l'absence de solution, une fois la recherche exhaustive terminée.
+ * @param trajets Les trajets entre points remarquables.
+ * @return l'explication à afficher.
+ */
+static const char *raisonSansSolution(Trajet trajets[NB_POINTS][NB_POINTS])
+{
+    if (trajets[POINT_ENTREE][POINT_SORTIE].longueur < 0)
+    {
+        return "Il n'y a pas de sortie.";
+    }
+    if (trajets[POINT_ENTREE][POINT_SORTIE].porteFermee)
+    {
+        return "La sortie est derriere la porte, et la cle est absente ou derriere la porte elle aussi.";
+    }
+    return "Aucun parcours n'atteint la sortie.";
+}
+
+/**
+ * Libération des mouvements d'une solution.
+ * @param solution La solution.
+ */
+void libererSolution(Solution *solution)
+{
+    free(solution->mouvements);
+    solution->mouvements = NULL;
+    solution->nbMouvements = 0;
+}
+
+/**
+ * Début du journal d'une nouvelle partie ; la mémoire déjà allouée est réutilisée.
+ * @param journal Le journal, initialisé à zéro ou déjà utilisé.
+ * @param graine La graine du générateur de la partie.
+ */
+void journalCommencer(Journal *journal, uint64_t graine)
+{
+    journal->graine = graine;
+    journal->nbCodes = 0;
+    journal->nbMouvements = 0;
+    journal->profondeur = 0;
+    journal->nbNonExplores = 0;
+    journal->cleTrouvee = false;
+    journal->gagnee = false;
+}
+
+/**
+ * Ajout d'un code à la fin du journal, qui grandit si nécessaire.
+ * @param journal Le journal.
+ * @param code Le code.
+ */
+static inline void journalAjouter(Journal *journal, CodeJournal code)
+{
+    uint64_t octet = journal->nbCodes / 4;
+    if (octet == journal->capacite)
+    {
+        uint64_t capacite = journal->capacite == 0 ? 256 : journal->capacite * 2;
+        uint8_t *codes = realloc(journal->codes, capacite);
+        if (codes == NULL)
+        {
+            perror("Erreur d'allocation mémoire pour le journal");
+            exit(EXIT_FAILURE);
+        }
+        journal->codes = codes;
+        journal->capacite = capacite;
+    }
+    if (journal->nbCodes % 4 == 0)
+    {
+        journal->codes[octet] = 0;
+    }
+    journal->codes[octet] |= (uint8_t)(code << (2 * (journal->nbCodes % 4)));
+    journal->nbCodes++;
+}
+
+/**
+ * Ajout d'un déplacement au journal. Un déplacement aléatoire est précédé de JOURNAL_ALEATOIRE :
+ * la direction obtenue est ainsi écrite, et la relecture peut vérifier que le tirage est le même.
+ * @param journal Le journal.
+ * @param direction La direction du déplacement (JOURNAL_HAUT, JOURNAL_GAUCHE ou JOURNAL_DROITE).
+ * @param aleatoire Le déplacement a été tiré au hasard (salle A).
+ */
+void journalMouvement(Journal *journal, CodeJournal direction, bool aleatoire)
+{
+    if (aleatoire)
+    {
+        journalAjouter(journal, JOURNAL_ALEATOIRE);
+    }
+    journalAjouter(journal, direction);
+    journal->nbMouvements++;
+}
+
+/**
+ * Lecture d'un code du journal.
+ * @param journal Le journal.
+ * @param i La position du code, inférieure à journal->nbCodes.
+ * @return le code.
+ */
+static inline CodeJournal lireCodeJournal(const Journal *journal, uint64_t i)
+{
+    return (CodeJournal)((journal->codes[i / 4] >> (2 * (i % 4))) & 3);
+}
+
+/**
+ * Libération de la mémoire du journal.
+ * @param journal Le journal.
+ */
+void libererJournal(Journal *journal)
+{
+    free(journal->codes);
+    journal->codes = NULL;
+    journal->nbCodes = 0;
+    journal->capacite = 0;
+}
+
+/**
+ * Écriture du message d'un événement, sauf dans une partie sans affichage.
+ * @param salle La salle du joueur.
+ * @param message Le message.
+ */
+static void messageEvent(const EtatSalle *salle, const char *message)
+{
+    if (salle->image != NULL)
+    {
+        tamponAjouter(salle->image, "%s", message);
+    }
+}
+
+/**
+ * Règle d'entrée de la sortie 'S' : la partie est gagnée.
+ * @param salle La salle du joueur.
+ * @return ACTION_SORTIE.
+ */
+static int entrerSortie(const EtatSalle *salle)
+{
+    messageEvent(salle, "Felicitations ! Vous avez trouve la sortie.\n");
+    return ACTION_SORTIE;
+}
+
+/**
+ * Règle d'entrée de la salle 'U' : à la première visite, retour au début.
+ * @param salle La salle du joueur.
+ * @return ACTION_CHUTE à la première visite.
+ */
+static int entrerChute(const EtatSalle *salle)
+{
+    if (salle->dejaVisitee)
+    {
+        return 0;
+    }
+    messageEvent(salle, "Vous tombez de l'arbre ! Retour au debut.\n");
+    return ACTION_CHUTE;
+}
+
+/**
+ * Règle d'entrée de la salle 'A' : à la première visite, le prochain mouvement est aléatoire.
+ * @param salle La salle du joueur.
+ * @return ACTION_ALEATOIRE à la première visite.
+ */
+static int entrerAleatoire(const EtatSalle *salle)
+{
+    if (salle->dejaVisitee)
+    {
+        return 0;
+    }
+    messageEvent(salle, "Tu es desoriente, ton prochain mouvement sera aleatoire.\n");
+    return ACTION_ALEATOIRE;
+}
+
+/**
+ * Règle d'entrée de la salle 'R' : à la première visite, toutes les visites sont oubliées.
+ * @param salle La salle du joueur.
+ * @return ACTION_OUBLIER à la première visite.
+ */
+static int entrerOubli(const EtatSalle *salle)
+{
+    if (salle->dejaVisitee)
+    {
+        return 0;
+    }
+    messageEvent(salle, "Vous avez perdu la memoire, vous ne savez plus ou vous etes.\n");
+    return ACTION_OUBLIER;
+}
+
+/**
+ * Règle d'entrée de la salle 'B' : le brouillard n'est jamais marqué comme visité.
+ * @param salle La salle du joueur.
+ * @return ACTION_BROUILLARD.
+ */
+static int entrerBrouillard(const EtatSalle *salle)
+{
+    messageEvent(salle, "Il y a beaucoup de brouillard ici ...\n");
+    return ACTION_BROUILLARD;
+}
+
+/**
+ * Règle d'entrée de la porte 'D' : à la première visite, on indique si le joueur a la clé.
+ * @param salle La salle du joueur.
+ * @return aucune action, la porte bloque le passage avec bloquerPorte.
+ */
+static int entrerPorte(const EtatSalle *salle)
+{
+    if (!salle->dejaVisitee)
+    {
+        messageEvent(salle, salle->cleTrouvee
+                                ? "Vous tombez sur une porte fermee a cle, et ca tombe bien, vous avez deja la cle !\n"
+                                : "Vous tombez sur une porte fermee a cle. Mais ou est la cle pour avancer ?\n");
+    }
+    return 0;
+}
+
+/**
+ * Règle d'entrée de la clé 'K' : à la première visite, le joueur trouve la clé.
+ * @param salle La salle du joueur.
+ * @return ACTION_CLE à la première visite.
+ */
+static int entrerCle(const EtatSalle *salle)
+{
+    if (salle->dejaVisitee)
+    {
+        return 0;
+    }
+    messageEvent(salle, "Vous trouvez une cle ! Mais ou est la porte ?\n");
+    return ACTION_CLE;
+}
+
+/**
+ * Règle de passage de la porte 'D' : on ne descend pas sans la clé.
+ * @param salle La salle du joueur.
+ * @return vrai si le joueur n'a pas la clé.
+ */
+static bool bloquerPorte(const EtatSalle *salle)
+{
+    if (salle->cleTrouvee)
+    {
+        return false;
+    }
+    messageEvent(salle, "La porte est fermee a cle, vous ne pouvez pas passer.\n");
+    return true;
+}
+
+/**
+ * Type d'un événement, lu directement dans indiceEvent : le coût ne dépend pas du nombre de types d'événements.
+ * @param event L'octet de l'événement.
+ * @return le type de l'événement, avec ses règles.
+ */
+static inline const EventType *typeEvent(char event)
+{
+    return &eventTypes[indiceEvent[(unsigned char)event]];
+}
+
+/**
+ * Relevé de l'entrée dans une salle pour les statistiques.
+ * @param type Le type d'événement de la salle.
+ */
+static inline void compterDeclenchement(const EventType *type)
+{
+    if (releves.actives)
+    {
+        releves.declenchements[type - eventTypes]++;
+    }
+}
+
+/**
+ * Initialisation d'un arbre compact de taille donnée.
+ * Les nœuds sont numérotés en ordre préfixe : la racine a l'indice 0 et un parent a toujours
+ * un indice inférieur à celui de ses enfants, ce qui permet de nombreux parcours séquentiels.
+ * @param taille Le nombre de nœuds de l'arbre.
+ * @return l'arbre compact initialisé, sans aucun lien ni nœud visité.
+ */
+ArbreCompact *initCompact(uint32_t taille)
+{
+    ArbreCompact *arbre = malloc(sizeof(ArbreCompact));
+    if (arbre == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour l'arbre compact");
+        exit(EXIT_FAILURE);
+    }
+    arbre->taille = taille;
+    arbre->gauche = malloc(taille * sizeof(uint32_t));
+    arbre->droite = malloc(taille * sizeof(uint32_t));
+    arbre->parent = malloc(taille * sizeof(uint32_t));
+    arbre->events = malloc(taille);
+    arbre->visite = calloc((taille + 63) / 64, sizeof(uint64_t)); // Aucun nœud visité
+    if (arbre->gauche == NULL || arbre->droite == NULL || arbre->parent == NULL || arbre->events == NULL || arbre->visite == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour les noeuds de l'arbre compact");
+        exit(EXIT_FAILURE);
+    }
+    arbre->current = 0;
+    arbre->nbNonExplores = taille;
+    arbre->projection = NULL;
+    arbre->tailleProjection = 0;
+    return arbre;
+}
+
+/**
+ * Destruction d'un arbre compact.
+ * @param arbre L'arbre compact à détruire.
+ */
+void detruireArbreCompact(ArbreCompact *arbre)
+{
+    if (arbre == NULL)
+    {
+        return;
+    }
+    if (arbre->projection != NULL) // Les tableaux sont dans le fichier ouvert
+    {
+#ifdef _WIN32
+        free(arbre->projection);
+#else
+        munmap(arbre->projection, arbre->tailleProjection);
+#endif
+    }
+    else
+    {
+        free(arbre->gauche);
+        free(arbre->droite);
+        free(arbre->parent);
+        free(arbre->events);
+    }
+    free(arbre->visite);
+    free(arbre);
+}
+
+/**
+ * Indique si un nœud de l'arbre compact a été visité.
+ * @param arbre L'arbre compact.
+ * @param noeud L'indice du nœud.
+ * @return true si le nœud a été visité.
+ */
+static inline bool estVisiteCompact(const ArbreCompact *arbre, uint32_t noeud)
+{
+    return (arbre->visite[noeud / 64] >> (noeud % 64)) & 1;
+}
+
+/**
+ * Marque un nœud de l'arbre compact comme visité en tenant à jour le nombre de nœuds non explorés.
+ * @param arbre L'arbre compact.
+ * @param noeud L'indice du nœud.
+ */
+static inline void marquerVisiteCompact(ArbreCompact *arbre, uint32_t noeud)
+{
+    uint64_t masque = (uint64_t)1 << (noeud % 64);
+    if ((arbre->visite[noeud / 64] & masque) == 0)
+    {
+        arbre->visite[noeud / 64] |= masque;
+        arbre->nbNonExplores--;
+    }
+}
+
+/**
+ * Conversion d'un arbre en sa représentation compacte.
+ * L'arbre est parcouru en ordre préfixe avec une pile explicite pour numéroter les nœuds.
+ * @param arbre L'arbre à convertir (il n'est pas modifié).
+ * @return le nouvel arbre compact, avec la même position du joueur et les mêmes nœuds visités.
+ */
+ArbreCompact *compacterArbre(Arbre *arbre)
+{
+    uint32_t taille = (uint32_t)nombreElement(arbre->premier);
+    ArbreCompact *compact = initCompact(taille);
+    if (taille == 0)
+    {
+        return compact;
+    }
+
+    // Pile des nœuds restant à numéroter, avec l'indice de leur parent
+    Element **pile = malloc(taille * sizeof(Element *));
+    uint32_t *pileParent = malloc(taille * sizeof(uint32_t));
+    if (pile == NULL || pileParent == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour la pile de parcours");
+        exit(EXIT_FAILURE);
+    }
+    uint32_t sommet = 0;
+    uint32_t suivant = 0; // Prochain indice libre
+    pile[sommet] = arbre->premier;
+    pileParent[sommet++] = AUCUN_NOEUD;
+
+    while (sommet > 0)
+    {
+        sommet--;
+        Element *element = pile[sommet];
+        uint32_t parent = pileParent[sommet];
+        uint32_t indice = suivant++;
+
+        compact->gauche[indice] = AUCUN_NOEUD;
+        compact->droite[indice] = AUCUN_NOEUD;
+        compact->parent[indice] = parent;
+        compact->events[indice] = element->event;
+        if (parent != AUCUN_NOEUD) // On relie le nœud à son parent
+        {
+            if (element == element->parent->suivantG)
+                compact->gauche[parent] = indice;
+            else
+                compact->droite[parent] = indice;
+        }
+        if (estVisite(arbre, element))
+        {
+            marquerVisiteCompact(compact, indice);
+        }
+        if (element == arbre->current)
+        {
+            compact->current = indice;
+        }
+
+        // On empile le droit en premier pour numéroter le sous-arbre gauche d'abord
+        if (element->suivantD != NULL)
+        {
+            pile[sommet] = element->suivantD;
+            pileParent[sommet++] = indice;
+        }
+        if (element->suivantG != NULL)
+        {
+            pile[sommet] = element->suivantG;
+            pileParent[sommet++] = indice;
+        }
+    }
+
+    free(pile);
+    free(pileParent);
+    return compact;
+}
+
+/**
+ * Indique si la machine range les entiers en petit-boutiste, l'ordre du format de fichier.
+ * @return true sur les machines petit-boutistes.
+ */
+static bool estPetitBoutiste()
+{
+    const uint32_t un = 1;
+    return *(const unsigned char *)&un == 1;
+}
+
+/**
+ * Sauvegarde d'un labyrinthe compact dans un fichier binaire versionné.
+ * Le fichier contient un en-tête (EnteteFichier) puis les tableaux de l'arbre tels qu'ils sont en mémoire :
+ * gauche, droite et parent (4 octets par nœud chacun), puis events (1 octet par nœud).
+ * Les visites ne sont pas sauvegardées : un labyrinthe rouvert recommence à l'entrée.
+ * @param arbre L'arbre compact.
+ * @param chemin Le chemin du fichier, remplacé s'il existe.
+ * @return true si le fichier a été écrit entièrement.
+ */
+bool sauvegarderLabyrinthe(const ArbreCompact *arbre, const char *chemin)
+{
+    if (!estPetitBoutiste())
+    {
+        fprintf(stderr, "Format de fichier non pris en charge sur une machine gros-boutiste\n");
+        return false;
+    }
+    EnteteFichier entete = {{0}, VERSION_FICHIER, sizeof(EnteteFichier), arbre->taille, AUCUN_NOEUD, AUCUN_NOEUD, AUCUN_NOEUD, 0};
+    memcpy(entete.magie, MAGIE_FICHIER, sizeof(entete.magie));
+    for (uint32_t i = 0; i < arbre->taille; i++)
+    {
+        if (arbre->events[i] == 'S')
+            entete.sortie = i;
+        else if (arbre->events[i] == 'K')
+            entete.cle = i;
+        else if (arbre->events[i] == 'D')
+            entete.porte = i;
+    }
+
+    FILE *fichier = fopen(chemin, "wb");
+    if (fichier == NULL)
+    {
+        perror("Erreur d'ouverture du fichier de labyrinthe");
+        return false;
+    }
+    size_t taille = arbre->taille;
+    bool ecrit = fwrite(&entete, sizeof(entete), 1, fichier) == 1 &&
+                 fwrite(arbre->gauche, sizeof(uint32_t), taille, fichier) == taille &&
+                 fwrite(arbre->droite, sizeof(uint32_t), taille, fichier) == taille &&
+                 fwrite(arbre->parent, sizeof(uint32_t), taille, fichier) == taille &&
+                 fwrite(arbre->events, 1, taille, fichier) == taille;
+    if (fclose(fichier) != 0)
+    {
+        ecrit = false;
+    }
+    if (!ecrit)
+    {
+        perror("Erreur d'écriture du fichier de labyrinthe");
+    }
+    return ecrit;
+}
+
+/**
+ * Fils gauche d'un nœud de l'arbre compact. Un arbre ouvert avec ouvrirLabyrinthe n'est pas parcouru à l'ouverture :
+ * ses liens sont vérifiés quand on les suit. En ordre préfixe, un enfant suit son parent dans l'arbre ;
+ * un lien qui ne le fait pas est ignoré, si bien que tout déplacement reste dans l'arbre et toute remontée s'arrête.
+ * @param arbre L'arbre compact.
+ * @param noeud L'indice du nœud.
+ * @return l'indice du fils gauche, AUCUN_NOEUD s'il n'y en a pas.
+ */
+static inline uint32_t gaucheCompact(const ArbreCompact *arbre, uint32_t noeud)
+{
+    uint32_t gauche = arbre->gauche[noeud];
+    return gauche > noeud && gauche < arbre->taille ? gauche : AUCUN_NOEUD;
+}
+
+/**
+ * Fils droit d'un nœud de l'arbre compact, vérifié comme dans gaucheCompact.
+ * @param arbre L'arbre compact.
+ * @param noeud L'indice du nœud.
+ * @return l'indice du fils droit, AUCUN_NOEUD s'il n'y en a pas.
+ */
+static inline uint32_t droiteCompact(const ArbreCompact *arbre, uint32_t noeud)
+{
+    uint32_t droite = arbre->droite[noeud];
+    return droite > noeud && droite < arbre->taille ? droite : AUCUN_NOEUD;
+}
+
+/**
+ * Parent d'un nœud de l'arbre compact, vérifié comme dans gaucheCompact : il précède le nœud.
+ * @param arbre L'arbre compact.
+ * @param noeud L'indice du nœud.
+ * @return l'indice du parent, AUCUN_NOEUD pour l'entrée.
+ */
+static inline uint32_t parentCompact(const ArbreCompact *arbre, uint32_t noeud)
+{
+    uint32_t parent = arbre->parent[noeud];
+    return parent < noeud ? parent : AUCUN_NOEUD;
+}
+
+/**
+ * Ouverture d'un labyrinthe sauvegardé par sauvegarderLabyrinthe, sans recopier ni reconstruire ses nœuds.
+ * Le fichier est projeté en mémoire (mmap) et les tableaux de l'arbre compact pointent directement dedans :
+ * l'ouverture ne coûte que la vérification de l'en-tête, et seules les pages des salles parcourues restent
+ * ensuite en mémoire. La projection est privée : le fichier n'est jamais modifié. Sous Windows, le fichier est lu d'un bloc.
+ * Les nœuds ne sont pas parcourus : le jeu, le solveur et l'export suivent les liens avec gaucheCompact,
+ * droiteCompact et parentCompact, qui ignorent les indices hors de l'ordre préfixe d'un fichier abîmé ou forgé.
+ * @param chemin Le chemin du fichier.
+ * @return l'arbre compact, le joueur à l'entrée, ou NULL si le fichier est illisible ou invalide.
+ */
+ArbreCompact *ouvrirLabyrinthe(const char *chemin)
+{
+    if (!estPetitBoutiste())
+    {
+        fprintf(stderr, "Format de fichier non pris en charge sur une machine gros-boutiste\n");
+        return NULL;
+    }
+    void *projection;
+    size_t tailleFichier;
+#ifdef _WIN32
+    FILE *fichier = fopen(chemin, "rb");
+    if (fichier == NULL)
+    {
+        perror("Erreur d'ouverture du fichier de labyrinthe");
+        return NULL;
+    }
+    _fseeki64(fichier, 0, SEEK_END);
+    tailleFichier = (size_t)_ftelli64(fichier);
+    _fseeki64(fichier, 0, SEEK_SET);
+    projection = malloc(tailleFichier > 0 ? tailleFichier : 1);
+    if (projection == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour le fichier de labyrinthe");
+        exit(EXIT_FAILURE);
+    }
+    if (fread(projection, 1, tailleFichier, fichier) != tailleFichier)
+    {
+        perror("Erreur de lecture du fichier de labyrinthe");
+        fclose(fichier);
+        free(projection);
+        return NULL;
+    }
+    fclose(fichier);
+#else
+    int descripteur = open(chemin, O_RDONLY);
+    if (descripteur < 0)
+    {
+        perror("Erreur d'ouverture du fichier de labyrinthe");
+        return NULL;
+    }
+    struct stat etat;
+    if (fstat(descripteur, &etat) != 0 || etat.st_size < (off_t)sizeof(EnteteFichier))
+    {
+        fprintf(stderr, "Fichier de labyrinthe invalide : %s\n", chemin);
+        close(descripteur);
+        return NULL;
+    }
+    tailleFichier = (size_t)etat.st_size;
+    projection = mmap(NULL, tailleFichier, PROT_READ | PROT_WRITE, MAP_PRIVATE, descripteur, 0);
+    close(descripteur); // La projection reste valable après la fermeture
+    if (projection == MAP_FAILED)
+    {
+        perror("Erreur de projection du fichier de labyrinthe");
+        return NULL;
+    }
+#endif
+
+    // Vérification de l'en-tête et de la taille du fichier, sans parcourir les nœuds
+    const EnteteFichier *entete = projection;
+    const char *raison = NULL;
+    if (tailleFichier < sizeof(EnteteFichier) || memcmp(entete->magie, MAGIE_FICHIER, sizeof(entete->magie)) != 0)
+        raison = "ce n'est pas un fichier de labyrinthe";
+    else if (entete->version != VERSION_FICHIER)
+        raison = "version du format non prise en charge";
+    else if (entete->tailleEntete < sizeof(EnteteFichier) || entete->tailleEntete % 8 != 0 || entete->taille == 0 ||
+             tailleFichier != entete->tailleEntete + (uint64_t)entete->taille * (3 * sizeof(uint32_t) + 1))
+        raison = "taille incohérente";
+    else if (entete->sortie >= entete->taille ||
+             ((const char *)projection + entete->tailleEntete + 3 * (size_t)entete->taille * sizeof(uint32_t))[entete->sortie] != 'S')
+        raison = "sortie introuvable";
+    if (raison != NULL)
+    {
+        fprintf(stderr, "Fichier de labyrinthe invalide (%s) : %s\n", raison, chemin);
+#ifdef _WIN32
+        free(projection);
+#else
+        munmap(projection, tailleFichier);
+#endif
+        return NULL;
+    }
+
+    ArbreCompact *arbre = malloc(sizeof(ArbreCompact));
+    if (arbre == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour l'arbre compact");
+        exit(EXIT_FAILURE);
+    }
+    uint32_t taille = entete->taille;
+    char *tableaux = (char *)projection + entete->tailleEntete;
+    arbre->taille = taille;
+    arbre->gauche = (uint32_t *)tableaux;
+    arbre->droite = arbre->gauche + taille;
+    arbre->parent = arbre->droite + taille;
+    arbre->events = (char *)(arbre->parent + taille);
+    arbre->visite = calloc((taille + 63) / 64, sizeof(uint64_t));
+    if (arbre->visite == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour les visites");
+        exit(EXIT_FAILURE);
+    }
+    arbre->current = 0;
+    arbre->nbNonExplores = taille;
+    arbre->projection = projection;
+    arbre->tailleProjection = tailleFichier;
+    marquerVisiteCompact(arbre, 0); // L'entrée est déjà visitée
+    return arbre;
+}
+
+/**
+ * Réservation de place à la fin d'un tampon, qui grandit si nécessaire.
+ * @param tampon Le tampon.
+ * @param taille Le nombre d'octets à pouvoir ajouter.
+ */
+static void tamponReserver(Tampon *tampon, size_t taille)
+{
+    if (tampon->capacite - tampon->taille >= taille)
+    {
+        return;
+    }
+    size_t capacite = tampon->capacite == 0 ? 4096 : tampon->capacite;
+    while (capacite - tampon->taille < taille)
+    {
+        capacite *= 2;
+    }
+    char *donnees = realloc(tampon->donnees, capacite);
+    if (donnees == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour le tampon d'export");
+        exit(EXIT_FAILURE);
+    }
+    tampon->donnees = donnees;
+    tampon->capacite = capacite;
+}
+
+/**
+ * Écriture d'un texte à une position, sans le zéro final.
+ * @param position La position où écrire.
+ * @param texte Le texte.
+ * @return la position qui suit le texte.
+ */
+static char *ecrireTexte(char *position, const char *texte)
+{
+    size_t longueur = strlen(texte);
+    memcpy(position, texte, longueur);
+    return position + longueur;
+}
+
+/**
+ * Écriture d'un entier en décimal à une position, sans passer par printf.
+ * @param position La position où écrire.
+ * @param valeur L'entier.
+ * @return la position qui suit l'entier.
+ */
+static char *ecrireEntier(char *position, uint32_t valeur)
+{
+    char chiffres[10];
+    int nombre = 0;
+    do
+    {
+        chiffres[nombre++] = '0' + valeur % 10;
+        valeur /= 10;
+    } while (valeur != 0);
+    while (nombre > 0)
+    {
+        *position++ = chiffres[--nombre];
+    }
+    return position;
+}
+
+/**
+ * Écriture d'une salle dans un export, avec l'arête qui la relie à son parent.
+ * Les exports servent pour des millions de salles : le texte est composé directement dans le tampon, sans printf.
+ * @param tampon Le tampon de l'export, vidé dans le flux par lots de TAILLE_LOT_EXPORT octets.
+ * @param flux Le flux de l'export.
+ * @param format Le format de l'export.
+ * @param id Le numéro de la salle (ordre préfixe).
+ * @param parent Le numéro de son parent, AUCUN_NOEUD pour l'entrée.
+ * @param aGauche La salle est le fils gauche de son parent.
+ * @param profondeur La profondeur de la salle, 0 pour l'entrée.
+ * @param event L'événement de la salle.
+ * @param visite La salle a été visitée.
+ * @param joueur Le joueur est dans la salle.
+ */
+static void exporterSalle(Tampon *tampon, FILE *flux, FormatExport format, uint32_t id, uint32_t parent, bool aGauche,
+                          uint32_t profondeur, char event, bool visite, bool joueur)
+{
+    tamponReserver(tampon, 192); // Plus long que la plus longue salle possible
+    char *position = tampon->donnees + tampon->taille;
+    if (format == EXPORT_DOT)
+    {
+        position = ecrireEntier(ecrireTexte(position, "  n"), id);
+        position = ecrireTexte(position, " [label=\"");
+        *position++ = event;
+        *position++ = '"';
+        if (visite)
+        {
+            position = ecrireTexte(position, ", fillcolor=lightgrey");
+        }
+        if (joueur)
+        {
+            position = ecrireTexte(position, ", color=red, penwidth=3");
+        }
+        position = ecrireTexte(position, "];\n");
+        if (parent != AUCUN_NOEUD)
+        {
+            position = ecrireEntier(ecrireTexte(position, "  n"), parent);
+            position = ecrireEntier(ecrireTexte(position, " -> n"), id);
+            position = ecrireTexte(position, aGauche ? " [label=\"g\"];\n" : " [label=\"d\"];\n");
+        }
+    }
+    else
+    {
+        position = ecrireEntier(ecrireTexte(position, "{\"id\":"), id);
+        if (parent == AUCUN_NOEUD)
+        {
+            position = ecrireTexte(position, ",\"parent\":null,\"cote\":null");
+        }
+        else
+        {
+            position = ecrireEntier(ecrireTexte(position, ",\"parent\":"), parent);
+            position = ecrireTexte(position, aGauche ? ",\"cote\":\"gauche\"" : ",\"cote\":\"droite\"");
+        }
+        position = ecrireEntier(ecrireTexte(position, ",\"profondeur\":"), profondeur);
+        position = ecrireTexte(position, ",\"event\":\"");
+        *position++ = event;
+        position = ecrireTexte(position, visite ? "\",\"visite\":true" : "\",\"visite\":false");
+        position = ecrireTexte(position, joueur ? ",\"joueur\":true}\n" : ",\"joueur\":false}\n");
+    }
+    tampon->taille = position - tampon->donnees;
+    if (tampon->taille >= TAILLE_LOT_EXPORT)
+    {
+        fwrite(tampon->donnees, 1, tampon->taille, flux);
+        tampon->taille = 0;
+    }
+}
+
+/**
+ * Début d'un export : en-tête du graphe pour le format DOT.
+ * @param tampon Le tampon de l'export.
+ * @param format Le format de l'export.
+ */
+static void commencerExport(Tampon *tampon, FormatExport format)
+{
+    if (format == EXPORT_DOT)
+    {
+        tamponAjouter(tampon, "digraph labyrinthe {\n  node [shape=circle, style=filled, fillcolor=white];\n");
+    }
+}
+
+/**
+ * Fin d'un export : écriture de la fin du fichier et de ce qui reste dans le tampon.
+ * @param tampon Le tampon de l'export.
+ * @param format Le format de l'export.
+ * @param flux Le flux de l'export.
+ * @return true si tout a été écrit.
+ */
+static bool terminerExport(Tampon *tampon, FormatExport format, FILE *flux)
+{
+    if (format == EXPORT_DOT)
+    {
+        tamponAjouter(tampon, "}\n");
+    }
+    fwrite(tampon->donnees, 1, tampon->taille, flux);
+    tamponLiberer(tampon);
+    return fflush(flux) == 0 && !ferror(flux);
+}
+
+/**
+ * Export d'un arbre compact au format GraphViz (DOT) ou JSON lines.
+ * Les indices de l'arbre compact sont déjà dans l'ordre préfixe : ils servent de numéros, et la mémoire utilisée
+ * ne dépend pas de la taille de l'arbre. Un labyrinthe ouvert avec ouvrirLabyrinthe est lu directement dans le fichier.
+ * @param arbre L'arbre compact.
+ * @param format Le format de l'export.
+ * @param flux Le flux dans lequel écrire.
+ * @return true si tout a été écrit.
+ */
+bool exporterArbreCompact(const ArbreCompact *arbre, FormatExport format, FILE *flux)
+{
+    Tampon tampon = {0};
+    commencerExport(&tampon, format);
+    uint32_t profondeur = 0;
+    for (uint32_t i = 0; i < arbre->taille; i++)
+    {
+        uint32_t parent = parentCompact(arbre, i);
+        if (i > 0)
+        {
+            // Le nœud précédent est le parent, ou le dernier descendant du frère gauche : on remonte jusqu'au parent
+            for (uint32_t n = i - 1; n != parent && n != AUCUN_NOEUD; n = parentCompact(arbre, n))
+            {
+                profondeur--;
+            }
+            profondeur++;
+        }
+        exporterSalle(&tampon, flux, format, i, parent, parent != AUCUN_NOEUD && arbre->gauche[parent] == i, profondeur,
+                      arbre->events[i], estVisiteCompact(arbre, i), i == arbre->current);
+    }
+    return terminerExport(&tampon, format, flux);
+}
+
+/**
+ * Construction d'un arbre de forme aléatoire uniforme dans des tableaux d'arbre compact, à partir d'un indice donné.
+ * On utilise l'algorithme de Rémy : un arbre binaire complet grandit en insérant, à chaque étape,
+ * un nœud interne au-dessus d'un nœud tiré au hasard. Ses nœuds internes forment alors un arbre
+ * binaire de `nombre` nœuds, tiré uniformément parmi toutes les formes possibles.
+ * Les nœuds sont ensuite renumérotés en ordre préfixe à partir de `debut`, et une feuille est tirée
+ * au hasard pendant ce même parcours. Les tableaux ne reçoivent que les nœuds de debut à debut + nombre - 1,
+ * le nœud `debut` dans leur première case : plusieurs threads peuvent construire des sous-arbres disjoints
+ * du même arbre en même temps, ou un sous-arbre peut être construit seul dans un petit tampon.
+ * @param gauche Les fils gauches du sous-arbre.
+ * @param droite Les fils droits du sous-arbre.
+ * @param parent Les parents du sous-arbre.
+ * @param events Les événements du sous-arbre, tous 'X'.
+ * @param debut L'indice de la racine du sous-arbre dans l'arbre entier.
+ * @param nombre Le nombre de nœuds du sous-arbre, entre 1 et TAILLE_MAX_REMY.
+ * @param parentRacine Le parent de la racine du sous-arbre, AUCUN_NOEUD pour la racine de l'arbre.
+ * @param alea Le générateur pseudo-aléatoire.
+ * @param nbFeuilles Le nombre de feuilles du sous-arbre.
+ * @param feuille Une feuille tirée uniformément.
+ */
+static void construireArbreRemy(uint32_t *gauche, uint32_t *droite, uint32_t *parent, char *events, uint32_t debut,
+                                uint32_t nombre, uint32_t parentRacine, Alea *alea, uint32_t *nbFeuilles, uint32_t *feuille)
+{
+    // Arbre complet de Rémy : les nœuds internes ont des indices impairs, les feuilles des indices pairs.
+    // Pour chaque nœud on retient la case de `fils` qui pointe vers lui, la dernière case tenant la racine.
+    uint32_t total = 2 * nombre + 1;
+    uint32_t *fils = malloc((2 * (size_t)total + 1) * sizeof(uint32_t)); // Fils gauche puis droit de chaque nœud
+    uint32_t *lien = malloc(total * sizeof(uint32_t));
+    if (fils == NULL || lien == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour la génération de l'arbre");
+        exit(EXIT_FAILURE);
+    }
+    uint32_t caseRacine = 2 * total;
+    fils[caseRacine] = 0;
+    lien[0] = caseRacine;
+    for (uint32_t k = 0; k < nombre; k++)
+    {
+        uint32_t tirage = aleaBorne(alea, 2 * (2 * k + 1)); // Un seul tirage pour le nœud et le côté
+        uint32_t cible = tirage / 2;                         // Nœud au-dessus duquel on insère
+        uint32_t cote = tirage % 2;                          // Côté où la cible est accrochée au nouveau nœud
+        uint32_t interne = 2 * k + 1;
+        uint32_t nouvelleFeuille = 2 * k + 2;
+
+        fils[lien[cible]] = interne; // Le nouveau nœud interne prend la place de la cible
+        lien[interne] = lien[cible];
+        fils[2 * interne + cote] = cible;
+        fils[2 * interne + 1 - cote] = nouvelleFeuille;
+        lien[cible] = 2 * interne + cote;
+        lien[nouvelleFeuille] = 2 * interne + 1 - cote;
+    }
+    uint32_t racine = fils[caseRacine];
+    free(lien);
+
+    // Renumérotation des nœuds internes en ordre préfixe, avec une pile de (nœud de Rémy, parent * 2 + côté).
+    // Le parent y est compté depuis `debut` : la case ne dépend que de la taille du sous-arbre, jamais de sa place
+    // dans un labyrinthe de plus de 2^31 nœuds.
+    uint32_t *pile = malloc(2 * ((size_t)nombre + 1) * sizeof(uint32_t));
+    if (pile == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour la pile de parcours");
+        exit(EXIT_FAILURE);
+    }
+    uint32_t sommet = 0;
+    uint32_t suivant = debut;
+    *nbFeuilles = 0;
+    *feuille = debut;
+    pile[sommet++] = racine;
+    pile[sommet++] = AUCUN_NOEUD;
+    while (sommet > 0)
+    {
+        uint32_t attache = pile[--sommet];
+        uint32_t noeud = pile[--sommet];
+        uint32_t indice = suivant++;
+        uint32_t filsGauche = fils[2 * noeud];
+        uint32_t filsDroit = fils[2 * noeud + 1];
+
+        gauche[indice - debut] = AUCUN_NOEUD;
+        droite[indice - debut] = AUCUN_NOEUD;
+        events[indice - debut] = 'X';
+        if (attache == AUCUN_NOEUD)
+        {
+            parent[indice - debut] = parentRacine;
+        }
+        else
+        {
+            parent[indice - debut] = debut + attache / 2;
+            if (attache % 2 == 0)
+                gauche[attache / 2] = indice;
+            else
+                droite[attache / 2] = indice;
+        }
+
+        if (filsGauche % 2 == 0 && filsDroit % 2 == 0) // Feuille du labyrinthe, candidate pour la sortie
+        {
+            if (aleaBorne(alea, ++*nbFeuilles) == 0)
+            {
+                *feuille = indice;
+            }
+        }
+        if (filsDroit % 2 == 1) // On empile le droit en premier pour numéroter le sous-arbre gauche d'abord
+        {
+            pile[sommet++] = filsDroit;
+            pile[sommet++] = (indice - debut) * 2 + 1;
+        }
+        if (filsGauche % 2 == 1)
+        {
+            pile[sommet++] = filsGauche;
+            pile[sommet++] = (indice - debut) * 2;
+        }
+    }
+    free(pile);
+    free(fils);
+}
+
+/**
+ * Génération en temps linéaire d'un arbre compact de forme aléatoire uniforme (algorithme de Rémy,
+ * voir construireArbreRemy), avec la sortie placée dans une feuille tirée au hasard.
+ * @param nombre Le nombre de nœuds à générer, TAILLE_MAX_REMY au plus (genererArbreCompactParallele au-delà).
+ * @param alea Le générateur pseudo-aléatoire.
+ * @return le nouvel arbre compact, avec l'entrée 'E' à la racine et la sortie 'S' dans une feuille.
+ */
+ArbreCompact *genererArbreCompact(uint32_t nombre, Alea *alea)
+{
+    double debutNs = debutChrono();
+    if (nombre < 1)
+    {
+        nombre = 1; // Comme genererArbre, on crée toujours au moins l'entrée
+    }
+    ArbreCompact *arbre = initCompact(nombre);
+    uint32_t nbFeuilles, sortie;
+    construireArbreRemy(arbre->gauche, arbre->droite, arbre->parent, arbre->events, 0, nombre, AUCUN_NOEUD, alea,
+                        &nbFeuilles, &sortie);
+
+    arbre->events[0] = 'E'; // L'entrée est à la racine, déjà visitée
+    marquerVisiteCompact(arbre, 0);
+    arbre->events[sortie] = 'S';
+    finChrono(CHRONO_GENERER_ARBRE, debutNs);
+    return arbre;
+}
+
+/**
+ * Nombre de cœurs de la machine.
+ * @return le nombre de processeurs en ligne, au moins 1.
+ */
+int nombreCoeurs()
+{
+#ifdef _WIN32
+    SYSTEM_INFO informations;
+    GetSystemInfo(&informations);
+    return (int)informations.dwNumberOfProcessors;
+#else
+    long coeurs = sysconf(_SC_NPROCESSORS_ONLN);
+    return coeurs > 0 ? (int)coeurs : 1;
+#endif
+}
+
+/**
+ * Boucle d'un thread : prend la prochaine tâche libre jusqu'à ce qu'il n'en reste plus.
+ * @param argument Le travail partagé (TravailParallele).
+ * @return NULL.
+ */
+static void *travaillerEnParallele(void *argument)
+{
+    TravailParallele *travail = argument;
+    while (1)
+    {
+        uint32_t numero = atomic_fetch_add(&travail->prochaine, 1);
+        if (numero >= travail->nbTaches)
+        {
+            return NULL;
+        }
+        travail->tache(travail->contexte, numero);
+    }
+}
+
+/**
+ * Exécution de tâches numérotées de 0 à nbTaches - 1 sur plusieurs threads, le thread appelant compris.
+ * Les tâches sont prises une par une grâce à un compteur partagé : un thread qui finit en avance prend la suivante.
+ * Si un thread ne peut pas être créé, les autres font son travail.
+ * @param nbThreads Le nombre de threads à utiliser.
+ * @param nbTaches Le nombre de tâches.
+ * @param tache La fonction qui exécute une tâche, appelée avec le contexte et le numéro de la tâche.
+ * @param contexte Les données partagées par toutes les tâches.
+ */
+void executerEnParallele(int nbThreads, uint32_t nbTaches, void (*tache)(void *, uint32_t), void *contexte)
+{
+    TravailParallele travail = {tache, contexte, nbTaches, 0};
+    if (nbThreads > (int)nbTaches)
+    {
+        nbThreads = (int)nbTaches;
+    }
+    if (nbThreads < 1)
+    {
+        nbThreads = 1;
+    }
+    pthread_t *threads = malloc(nbThreads * sizeof(pthread_t));
+    if (threads == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour les threads");
+        exit(EXIT_FAILURE);
+    }
+    int nbLances = 0;
+    while (nbLances < nbThreads - 1 && pthread_create(&threads[nbLances], NULL, travaillerEnParallele, &travail) == 0)
+    {
+        nbLances++;
+    }
+    travaillerEnParallele(&travail);
+    for (int i = 0; i < nbLances; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+}
+
+/**
+ * Construction d'un sous-arbre par un thread, avec son propre générateur.
+ * @param contexte Les données partagées (ConstructionParallele).
+ * @param numero Le numéro du sous-arbre.
+ */
+static void construireSousArbre(void *contexte, uint32_t numero)
+{
+    ConstructionParallele *construction = contexte;
+    const Decoupage *decoupage = construction->decoupage;
+    ArbreCompact *arbre = construction->arbre;
+    uint32_t debut = decoupage->debut[numero];
+    Alea alea = construction->flux[numero];
+    construireArbreRemy(arbre->gauche + debut, arbre->droite + debut, arbre->parent + debut, arbre->events + debut, debut,
+                        decoupage->taille[numero], decoupage->colonne[numero], &alea, &construction->nbFeuilles[numero],
+                        &construction->feuille[numero]);
+}
+
+/**
+ * Découpage d'un arbre en une colonne de nœuds qui portent chacun un sous-arbre (voir genererArbreCompactParallele).
+ * Les sous-arbres ont presque tous la même taille ; le côté de chacun est tiré au hasard.
+ * Les places de tous les nœuds en ordre préfixe se déduisent des tailles : le nœud j de la colonne est suivi
+ * de son sous-arbre s'il est à gauche, sinon de la suite de la colonne, son sous-arbre venant après elle.
+ * @param nombre Le nombre de nœuds de l'arbre.
+ * @param nbSousArbres Le nombre de sous-arbres, au moins 1 et au plus nombre / 2.
+ * @param alea Le générateur pseudo-aléatoire.
+ * @param decoupage Le découpage à remplir, à libérer avec libererDecoupage.
+ */
+static void decouperArbre(uint32_t nombre, uint32_t nbSousArbres, Alea *alea, Decoupage *decoupage)
+{
+    decoupage->nbSousArbres = nbSousArbres;
+    decoupage->colonne = malloc(nbSousArbres * sizeof(uint32_t));
+    decoupage->debut = malloc(nbSousArbres * sizeof(uint32_t));
+    decoupage->taille = malloc(nbSousArbres * sizeof(uint32_t));
+    uint32_t *suffixe = malloc((nbSousArbres + 1) * sizeof(uint32_t)); // Taille de la colonne à partir de chaque nœud
+    if (decoupage->colonne == NULL || decoupage->debut == NULL || decoupage->taille == NULL || suffixe == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour le découpage de l'arbre");
+        exit(EXIT_FAILURE);
+    }
+
+    // Taille de chaque sous-arbre, puis taille de la colonne depuis chacun de ses nœuds
+    uint32_t reste = nombre - nbSousArbres;
+    for (uint32_t j = 0; j < nbSousArbres; j++)
+    {
+        decoupage->taille[j] = reste / nbSousArbres + (j < reste % nbSousArbres ? 1 : 0);
+    }
+    suffixe[nbSousArbres] = 0;
+    for (uint32_t j = nbSousArbres; j > 0; j--)
+    {
+        suffixe[j - 1] = suffixe[j] + 1 + decoupage->taille[j - 1];
+    }
+
+    // Nœuds de la colonne, et place de chaque sous-arbre en ordre préfixe
+    uint32_t indice = 0;
+    for (uint32_t j = 0; j < nbSousArbres; j++)
+    {
+        decoupage->colonne[j] = indice;
+        if (aleaBorne(alea, 2) == 0) // Sous-arbre à gauche, suite de la colonne à droite
+        {
+            decoupage->debut[j] = indice + 1;
+            indice += 1 + decoupage->taille[j];
+        }
+        else // Suite de la colonne à gauche, sous-arbre à droite
+        {
+            decoupage->debut[j] = indice + 1 + suffixe[j + 1];
+            indice += 1;
+        }
+    }
+    free(suffixe);
+}
+
+/**
+ * Liens d'un nœud de la colonne d'un découpage.
+ * @param decoupage Le découpage.
+ * @param j Le numéro du nœud dans la colonne.
+ * @param gauche Son fils gauche.
+ * @param droite Son fils droit.
+ * @param parent Son parent.
+ */
+static void lierColonne(const Decoupage *decoupage, uint32_t j, uint32_t *gauche, uint32_t *droite, uint32_t *parent)
+{
+    uint32_t suite = j + 1 < decoupage->nbSousArbres ? decoupage->colonne[j + 1] : AUCUN_NOEUD;
+    bool sousArbreAGauche = decoupage->debut[j] == decoupage->colonne[j] + 1;
+    *gauche = sousArbreAGauche ? decoupage->debut[j] : suite;
+    *droite = sousArbreAGauche ? suite : decoupage->debut[j];
+    *parent = j == 0 ? AUCUN_NOEUD : decoupage->colonne[j - 1];
+}
+
+/**
+ * Flux pseudo-aléatoires indépendants des sous-arbres : celui du sous-arbre j est le générateur
+ * avancé de (j + 1) * 2^128 tirages, le générateur lui-même restant au thread appelant.
+ * @param alea Le générateur, inchangé.
+ * @param nbSousArbres Le nombre de flux.
+ * @return le tableau des flux, à libérer.
+ */
+static Alea *fluxSousArbres(const Alea *alea, uint32_t nbSousArbres)
+{
+    Alea *flux = malloc(nbSousArbres * sizeof(Alea));
+    if (flux == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour les générateurs");
+        exit(EXIT_FAILURE);
+    }
+    Alea courant = *alea;
+    for (uint32_t j = 0; j < nbSousArbres; j++)
+    {
+        aleaSaut(&courant);
+        flux[j] = courant;
+    }
+    return flux;
+}
+
+/**
+ * Libération des tableaux d'un découpage.
+ * @param decoupage Le découpage.
+ */
+void libererDecoupage(Decoupage *decoupage)
+{
+    free(decoupage->colonne);
+    free(decoupage->debut);
+    free(decoupage->taille);
+    decoupage->colonne = decoupage->debut = decoupage->taille = NULL;
+    decoupage->nbSousArbres = 0;
+}
+
+/**
+ * Génération d'un très grand arbre compact sur plusieurs cœurs.
+ * L'arbre est formé d'une colonne de nœuds, chacun portant d'un côté tiré au hasard un sous-arbre
+ * d'environ TAILLE_SOUS_ARBRE nœuds et de l'autre côté le nœud suivant de la colonne.
+ * Les places de tous les nœuds en ordre préfixe se calculent à l'avance à partir des tailles :
+ * chaque sous-arbre est ensuite construit par l'algorithme de Rémy directement à sa place,
+ * par n'importe quel thread, avec son propre flux pseudo-aléatoire (voir aleaSaut).
+ * Le résultat ne dépend donc pas du nombre de threads.
+ * Chaque sous-arbre est de forme uniforme, mais pas l'arbre entier à cause de la colonne.
+ * La sortie est tirée uniformément parmi toutes les feuilles. Les petits arbres sont construits d'un seul bloc.
+ * @param nombre Le nombre de nœuds à générer.
+ * @param nbThreads Le nombre de threads à utiliser.
+ * @param alea Le générateur pseudo-aléatoire, dont on dérive le flux de chaque sous-arbre.
+ * @param decoupage Le découpage obtenu, pour genererEventsCompactParallele, à libérer avec libererDecoupage (peut être NULL).
+ * @return le nouvel arbre compact, avec l'entrée 'E' à la racine et la sortie 'S' dans une feuille.
+ */
+ArbreCompact *genererArbreCompactParallele(uint32_t nombre, int nbThreads, Alea *alea, Decoupage *decoupage)
+{
+    double debutNs = debutChrono();
+    if (nombre < 1)
+    {
+        nombre = 1;
+    }
+    ArbreCompact *arbre = initCompact(nombre);
+    uint32_t nbSousArbres = nombre / TAILLE_SOUS_ARBRE;
+    if (nbSousArbres > MAX_SOUS_ARBRES)
+    {
+        nbSousArbres = MAX_SOUS_ARBRES;
+    }
+    Decoupage resultat = {0, NULL, NULL, NULL};
+    uint32_t sortie;
+
+    if (nbSousArbres < 2) // Trop petit pour être découpé
+    {
+        uint32_t nbFeuilles;
+        construireArbreRemy(arbre->gauche, arbre->droite, arbre->parent, arbre->events, 0, nombre, AUCUN_NOEUD, alea,
+                            &nbFeuilles, &sortie);
+    }
+    else
+    {
+        Alea *flux = fluxSousArbres(alea, nbSousArbres);
+        decouperArbre(nombre, nbSousArbres, alea, &resultat);
+        uint32_t *nbFeuilles = malloc(nbSousArbres * sizeof(uint32_t));
+        uint32_t *feuille = malloc(nbSousArbres * sizeof(uint32_t));
+        if (nbFeuilles == NULL || feuille == NULL)
+        {
+            perror("Erreur d'allocation mémoire pour le découpage de l'arbre");
+            exit(EXIT_FAILURE);
+        }
+        for (uint32_t j = 0; j < nbSousArbres; j++)
+        {
+            uint32_t noeud = resultat.colonne[j];
+            lierColonne(&resultat, j, &arbre->gauche[noeud], &arbre->droite[noeud], &arbre->parent[noeud]);
+            arbre->events[noeud] = 'X';
+        }
+
+        ConstructionParallele construction = {arbre, &resultat, flux, nbFeuilles, feuille, 0, NULL};
+        executerEnParallele(nbThreads, nbSousArbres, construireSousArbre, &construction);
+
+        // Sortie : un sous-arbre tiré selon son nombre de feuilles, puis la feuille qu'il a tirée
+        uint64_t totalFeuilles = 0;
+        for (uint32_t j = 0; j < nbSousArbres; j++)
+        {
+            totalFeuilles += nbFeuilles[j];
+        }
+        uint32_t rang = aleaBorne(alea, (uint32_t)totalFeuilles);
+        uint32_t j = 0;
+        while (rang >= nbFeuilles[j])
+        {
+            rang -= nbFeuilles[j++];
+        }
+        sortie = feuille[j];
+        free(flux);
+        free(feuille);
+        free(nbFeuilles);
+    }
+
+    arbre->events[0] = 'E';
+    marquerVisiteCompact(arbre, 0);
+    arbre->events[sortie] = 'S';
+    if (decoupage != NULL)
+    {
+        *decoupage = resultat;
+    }
+    else
+    {
+        libererDecoupage(&resultat);
+    }
+    finChrono(CHRONO_GENERER_ARBRE, debutNs);
+    return arbre;
+}
+
+/**
+ * Comptage du nombre d'éléments dans l'arbre compact.
+ * @param arbre L'arbre compact.
+ * @return Nombre d'éléments dans l'arbre.
+ */
+uint32_t nombreElementCompact(const ArbreCompact *arbre)
+{
+    return arbre->taille; // Tous les nœuds sont rangés dans les tableaux
+}
+
+/**
+ * Compte le nombre de nœuds non explorés dans l'arbre compact.
+ * On compte les bits à 1 du bitset, 64 nœuds à la fois.
+ * @param arbre L'arbre compact.
+ * @return Nombre de nœuds non explorés.
+ */
+uint32_t compterNoeudsNonExploresCompact(const ArbreCompact *arbre)
+{
+    uint32_t visites = 0;
+    for (uint32_t i = 0; i < (arbre->taille + 63) / 64; i++)
+    {
+        visites += (uint32_t)__builtin_popcountll(arbre->visite[i]);
+    }
+    return arbre->taille - visites;
+}
+
+/**
+ * Collecte tous les nœuds de l'arbre compact, sauf l'entrée et la sortie.
+ * @param arbre L'arbre compact.
+ * @param noeuds Tableau d'indices à remplir.
+ * @return Nombre de nœuds collectés.
+ */
+uint32_t collecteNoeudsCompact(const ArbreCompact *arbre, uint32_t *noeuds)
+{
+    uint32_t nbNoeuds = 0;
+    for (uint32_t i = 0; i < arbre->taille; i++)
+    {
+        if (arbre->events[i] != 'E' && arbre->events[i] != 'S')
+        {
+            noeuds[nbNoeuds++] = i;
+        }
+    }
+    return nbNoeuds;
+}
+
+/**
+ * Génération des événements pour chaque nœud de l'arbre compact.
+ * La clé est placée sur le chemin le plus à gauche,
+ * la porte plus profonde que la clé, puis les autres événements au hasard.
+ * Si aucun nœud n'est plus profond que la clé, elle redevient un nœud standard : ni clé ni porte.
+ * @param arbre L'arbre compact.
+ * @param alea Le générateur pseudo-aléatoire.
+ */
+void genererEventsCompact(ArbreCompact *arbre, Alea *alea)
+{
+    double debutNs = debutChrono();
+    bool keyOK = false;
+    bool doorOK = false;
+
+    uint32_t *nodes = malloc(arbre->taille * sizeof(uint32_t));
+    uint32_t *profondeurs = malloc(arbre->taille * sizeof(uint32_t));
+    if (nodes == NULL || profondeurs == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour les nœuds");
+        exit(EXIT_FAILURE);
+    }
+    uint32_t nbNoeuds = collecteNoeudsCompact(arbre, nodes);
+
+    // Profondeur de chaque nœud (en comptant la racine), un parent précède toujours ses enfants
+    for (uint32_t i = 0; i < arbre->taille; i++)
+    {
+        profondeurs[i] = arbre->parent[i] == AUCUN_NOEUD ? 1 : profondeurs[arbre->parent[i]] + 1;
+    }
+
+    // Longueur du chemin le plus à gauche depuis la racine
+    uint32_t longueurChemin = 0;
+    for (uint32_t n = 0; n != AUCUN_NOEUD; n = arbre->gauche[n] != AUCUN_NOEUD ? arbre->gauche[n] : arbre->droite[n])
+    {
+        longueurChemin++;
+    }
+
+    uint32_t keyNode = AUCUN_NOEUD;
+    if (longueurChemin >= 3)
+    {
+        // On place 'K' à un nœud aléatoire entre l'entrée et la sortie
+        uint32_t keyIndex = 1 + aleaBorne(alea, longueurChemin - 2);
+        keyNode = 0;
+        for (uint32_t i = 0; i < keyIndex; i++)
+        {
+            keyNode = arbre->gauche[keyNode] != AUCUN_NOEUD ? arbre->gauche[keyNode] : arbre->droite[keyNode];
         }
-        else
+        arbre->events[keyNode] = 'K';
+        keyOK = true;
+
+        // On place 'D' à un nœud aléatoire parmi les nœuds plus profonds que la clé
+        uint32_t *deeperNodes = malloc(nbNoeuds * sizeof(uint32_t) + 1);
+        if (deeperNodes == NULL)
+        {
+            perror("Erreur d'allocation mémoire pour les nœuds plus profonds");
+            exit(EXIT_FAILURE);
+        }
+        uint32_t deeperNodeCount = 0;
+        for (uint32_t i = 0; i < nbNoeuds; i++)
+        {
+            if (nodes[i] != keyNode && nodes[i] != 0 && profondeurs[nodes[i]] > keyIndex)
+            {
+                deeperNodes[deeperNodeCount++] = nodes[i];
+            }
+        }
+        if (deeperNodeCount > 0)
+        {
+            arbre->events[deeperNodes[aleaBorne(alea, deeperNodeCount)]] = 'D';
+            doorOK = true;
+        }
+        free(deeperNodes);
+    }
+    free(profondeurs);
+
+    // On retire les nœuds avec 'K' et 'D' de la liste
+    for (uint32_t i = 0; i < nbNoeuds; i++)
+    {
+        if (arbre->events[nodes[i]] == 'K' || arbre->events[nodes[i]] == 'D')
+        {
+            nodes[i--] = nodes[--nbNoeuds];
+        }
+    }
+
+    // On assigne les événements restants, tirés selon leurs poids dans la limite de leurs quotas
+    char *events = malloc(nbNoeuds + 1);
+    if (events == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour les événements");
+        exit(EXIT_FAILURE);
+    }
+    tirerEvents(events, nbNoeuds, alea);
+    for (uint32_t i = 0; i < nbNoeuds; i++)
+    {
+        arbre->events[nodes[i]] = events[i];
+    }
+    free(events);
+    free(nodes);
+
+    if (keyOK && !doorOK) // Aucun nœud plus profond pour la porte : le labyrinthe n'a ni clé ni porte
+    {
+        arbre->events[keyNode] = 'X';
+    }
+    finChrono(CHRONO_GENERER_EVENTS, debutNs);
+}
+
+/**
+ * Recherche des nœuds candidats pour la porte dans un sous-arbre : nœuds standards plus profonds que la clé.
+ * Les profondeurs sont calculées dans l'ordre préfixe, un parent précédant toujours ses enfants.
+ * @param arbre L'arbre compact.
+ * @param debut L'indice de la racine du sous-arbre.
+ * @param taille Le nombre de nœuds du sous-arbre.
+ * @param profondeurRacine La profondeur de la racine du sous-arbre (la racine de l'arbre a la profondeur 1).
+ * @param profondeurCle La profondeur à dépasser.
+ * @param rang Le rang du candidat cherché, AUCUN_NOEUD pour seulement les compter.
+ * @return le nombre de candidats, ou l'indice du candidat de rang `rang`.
+ */
+static uint32_t chercherCandidatsPorte(const ArbreCompact *arbre, uint32_t debut, uint32_t taille,
+                                       uint32_t profondeurRacine, uint32_t profondeurCle, uint32_t rang)
+{
+    uint32_t *profondeurs = malloc(taille * sizeof(uint32_t));
+    if (profondeurs == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour les profondeurs");
+        exit(EXIT_FAILURE);
+    }
+    uint32_t nbCandidats = 0;
+    uint32_t trouve = AUCUN_NOEUD;
+    for (uint32_t i = 0; i < taille; i++)
+    {
+        profondeurs[i] = i == 0 ? profondeurRacine : profondeurs[arbre->parent[debut + i] - debut] + 1;
+        if (profondeurs[i] > profondeurCle && arbre->events[debut + i] == 'X')
+        {
+            if (nbCandidats++ == rang)
+            {
+                trouve = debut + i;
+                break;
+            }
+        }
+    }
+    free(profondeurs);
+    return rang == AUCUN_NOEUD ? nbCandidats : trouve;
+}
+
+/**
+ * Comptage par un thread des nœuds candidats pour la porte dans un sous-arbre.
+ * @param contexte Les données partagées (ConstructionParallele).
+ * @param numero Le numéro du sous-arbre.
+ */
+static void compterCandidatsPorte(void *contexte, uint32_t numero)
+{
+    ConstructionParallele *construction = contexte;
+    const Decoupage *decoupage = construction->decoupage;
+    construction->nbCandidats[numero] = chercherCandidatsPorte(construction->arbre, decoupage->debut[numero],
+                                                               decoupage->taille[numero], numero + 2,
+                                                               construction->profondeurCle, AUCUN_NOEUD);
+}
+
+/**
+ * Génération des événements d'un arbre compact généré en parallèle.
+ * Même règles que genererEventsCompact, sans liste de tous les nœuds ni mélange :
+ * - la clé est sur le chemin le plus à gauche, que l'on suit directement ;
+ * - la porte est tirée uniformément parmi les nœuds plus profonds que la clé, comptés sous-arbre par
+ *   sous-arbre sur tous les cœurs : on choisit un sous-arbre selon son nombre de candidats, puis un rang ;
+ * - le nombre d'occurrences des autres événements est tiré avec leurs poids et leurs quotas (tirerNombresEvents),
+ *   puis chacun est posé sur un nœud standard tiré au hasard, en retirant les nœuds déjà pris. Avec les poids
+ *   habituels, les nœuds pris sont très rares et il y a peu de retirages ; sinon le placement reste fini,
+ *   les nombres tirés ne dépassant jamais les nœuds standards.
+ * Les nœuds sont déjà des nœuds standards ('X') après la génération de la forme.
+ * @param arbre L'arbre compact, tel que généré par genererArbreCompactParallele.
+ * @param decoupage Son découpage (genererEventsCompact est utilisé pour un arbre non découpé).
+ * @param nbThreads Le nombre de threads à utiliser.
+ * @param alea Le générateur pseudo-aléatoire (seul le thread appelant tire des nombres).
+ */
+void genererEventsCompactParallele(ArbreCompact *arbre, const Decoupage *decoupage, int nbThreads, Alea *alea)
+{
+    if (decoupage == NULL || decoupage->nbSousArbres == 0)
+    {
+        genererEventsCompact(arbre, alea);
+        return;
+    }
+    double debutNs = debutChrono();
+
+    // Longueur du chemin le plus à gauche depuis la racine
+    uint32_t longueurChemin = 0;
+    for (uint32_t n = 0; n != AUCUN_NOEUD; n = arbre->gauche[n] != AUCUN_NOEUD ? arbre->gauche[n] : arbre->droite[n])
+    {
+        longueurChemin++;
+    }
+
+    uint32_t nbPlaces = 2; // L'entrée et la sortie, placées avec la forme
+    if (longueurChemin >= 3)
+    {
+        uint32_t keyIndex = 1 + aleaBorne(alea, longueurChemin - 2);
+        uint32_t keyNode = 0;
+        for (uint32_t i = 0; i < keyIndex; i++)
+        {
+            keyNode = arbre->gauche[keyNode] != AUCUN_NOEUD ? arbre->gauche[keyNode] : arbre->droite[keyNode];
+        }
+        arbre->events[keyNode] = 'K';
+
+        // Candidats pour la porte dans la colonne (profondeur j + 1), puis dans chaque sous-arbre
+        uint32_t nbSousArbres = decoupage->nbSousArbres;
+        uint32_t *nbCandidats = malloc(nbSousArbres * sizeof(uint32_t));
+        if (nbCandidats == NULL)
+        {
+            perror("Erreur d'allocation mémoire pour les candidats");
+            exit(EXIT_FAILURE);
+        }
+        uint64_t total = 0;
+        for (uint32_t j = 0; j < nbSousArbres; j++)
+        {
+            if (j + 1 > keyIndex && arbre->events[decoupage->colonne[j]] == 'X')
+            {
+                total++;
+            }
+        }
+        uint32_t nbCandidatsColonne = (uint32_t)total;
+        ConstructionParallele construction = {arbre, decoupage, NULL, NULL, NULL, keyIndex, nbCandidats};
+        executerEnParallele(nbThreads, nbSousArbres, compterCandidatsPorte, &construction);
+        for (uint32_t j = 0; j < nbSousArbres; j++)
+        {
+            total += nbCandidats[j];
+        }
+
+        if (total > 0)
+        {
+            uint32_t rang = aleaBorne(alea, (uint32_t)total);
+            uint32_t porte = AUCUN_NOEUD;
+            if (rang < nbCandidatsColonne)
+            {
+                for (uint32_t j = keyIndex; porte == AUCUN_NOEUD; j++) // Profondeur j + 1 > keyIndex
+                {
+                    if (arbre->events[decoupage->colonne[j]] == 'X' && rang-- == 0)
+                    {
+                        porte = decoupage->colonne[j];
+                    }
+                }
+            }
+            else
+            {
+                rang -= nbCandidatsColonne;
+                uint32_t j = 0;
+                while (rang >= nbCandidats[j])
+                {
+                    rang -= nbCandidats[j++];
+                }
+                porte = chercherCandidatsPorte(arbre, decoupage->debut[j], decoupage->taille[j], j + 2, keyIndex, rang);
+            }
+            arbre->events[porte] = 'D';
+            nbPlaces += 2;
+        }
+        else // Aucun nœud plus profond pour la porte : le labyrinthe n'a ni clé ni porte
+        {
+            arbre->events[keyNode] = 'X';
+        }
+        free(nbCandidats);
+    }
+
+    // Autres événements : leurs nombres sont tirés comme par tirerEvents sur les nœuds restants,
+    // puis chacun est posé sur un nœud standard tiré au hasard, ce qui revient au mélange de tirerEvents.
+    // Le nœud standard reste le fond : ses occurrences sont les nœuds qui n'ont rien reçu.
+    uint64_t nombres[NB_TYPES_EVENTS];
+    tirerNombresEvents(nombres, arbre->taille - nbPlaces, alea);
+    for (size_t j = 0; j < NB_TYPES_EVENTS; j++)
+    {
+        if (eventTypes[j].letter == 'X')
+            continue;
+        for (uint64_t k = 0; k < nombres[j]; k++) // Les nombres tirés ne dépassent pas les nœuds restants
+        {
+            uint32_t noeud;
+            do
+            {
+                noeud = aleaBorne(alea, arbre->taille);
+            } while (arbre->events[noeud] != 'X');
+            arbre->events[noeud] = eventTypes[j].letter;
+        }
+    }
+    finChrono(CHRONO_GENERER_EVENTS, debutNs);
+}
+
+/**
+ * Lettre affichée pour un nœud de l'arbre compact : son événement s'il a été visité, '?' sinon, 0 s'il n'existe pas.
+ * @param arbre L'arbre compact.
+ * @param noeud L'indice du nœud.
+ * @return la lettre à afficher.
+ */
+char lettreNoeudCompact(const ArbreCompact *arbre, uint32_t noeud)
+{
+    if (noeud == AUCUN_NOEUD)
+    {
+        return 0;
+    }
+    return estVisiteCompact(arbre, noeud) ? arbre->events[noeud] : '?';
+}
+
+/**
+ * Profondeur d'un nœud de l'arbre compact, en remontant jusqu'à la racine.
+ * @param arbre L'arbre compact.
+ * @param noeud L'indice du nœud.
+ * @return le nombre de mouvements depuis la racine.
+ */
+static uint32_t profondeurCompact(const ArbreCompact *arbre, uint32_t noeud)
+{
+    uint32_t profondeur = 0;
+    while ((noeud = parentCompact(arbre, noeud)) != AUCUN_NOEUD)
+    {
+        profondeur++;
+    }
+    return profondeur;
+}
+
+/**
+ * Analyse du chemin entre deux points remarquables de l'arbre compact : longueur, salles remarquables traversées
+ * et porte fermée sur le chemin.
+ * @param arbre L'arbre compact.
+ * @param points Les indices des points remarquables (AUCUN_NOEUD si absents).
+ * @param porte L'indice de la porte 'D', AUCUN_NOEUD si absente.
+ * @param depart Le point de départ.
+ * @param arrivee Le point d'arrivée.
+ * @param mouvements Le tableau où écrire les mouvements, NULL pour seulement analyser.
+ * @return le trajet.
+ */
+static Trajet analyserTrajetCompact(const ArbreCompact *arbre, const uint32_t points[NB_POINTS], uint32_t porte,
+                                    int depart, int arrivee, Touche *mouvements)
+{
+    Trajet trajet = {-1, 0, false};
+    uint32_t a = points[depart], b = points[arrivee];
+    if (a == AUCUN_NOEUD || b == AUCUN_NOEUD)
+    {
+        return trajet;
+    }
+    uint32_t profondeurA = profondeurCompact(arbre, a), profondeurB = profondeurCompact(arbre, b);
+    uint32_t montees = 0, descentes = 0;
+    uint32_t x = a, y = b;
+    while (x != y)
+    {
+        bool monterX = profondeurA - montees >= profondeurB - descentes;
+        bool monterY = profondeurB - descentes >= profondeurA - montees;
+        if (monterX)
+        {
+            x = parentCompact(arbre, x);
+            montees++;
+        }
+        if (monterY)
+        {
+            y = parentCompact(arbre, y);
+            descentes++;
+            if (y == porte)
+            {
+                trajet.porteFermee = true;
+            }
+        }
+        for (int p = 0; p < NB_POINTS; p++)
+        {
+            if (points[p] != AUCUN_NOEUD && points[p] != a && points[p] != b && (points[p] == x || points[p] == y))
+            {
+                trajet.traverses |= 1 << p;
+            }
+        }
+    }
+    trajet.longueur = montees + descentes;
+
+    if (mouvements != NULL)
+    {
+        for (uint32_t i = 0; i < montees; i++)
+        {
+            mouvements[i] = TOUCHE_HAUT;
+        }
+        y = b;
+        for (int i = trajet.longueur - 1; i >= (int)montees; i--)
+        {
+            uint32_t parent = parentCompact(arbre, y);
+            mouvements[i] = parent != AUCUN_NOEUD && arbre->gauche[parent] == y ? TOUCHE_GAUCHE : TOUCHE_DROITE;
+            y = parent;
+        }
+    }
+    return trajet;
+}
+
+/**
+ * Recherche du plus court parcours de l'entrée jusqu'à la sortie d'un arbre compact.
+ * Les salles remarquables sont trouvées en une lecture séquentielle du tableau des événements.
+ * @param arbre L'arbre compact à résoudre, depuis sa racine et sans aucune salle visitée.
+ * @return la solution, à libérer avec libererSolution.
+ */
+Solution resoudreLabyrintheCompact(const ArbreCompact *arbre)
+{
+    Solution solution = {false, NULL, 0, NULL};
+    uint32_t points[NB_POINTS] = {0, AUCUN_NOEUD, AUCUN_NOEUD, AUCUN_NOEUD, AUCUN_NOEUD};
+    uint32_t porte = AUCUN_NOEUD;
+    int aTrouver = 5;
+    for (uint32_t i = 0; i < arbre->taille && aTrouver > 0; i++)
+    {
+        switch (arbre->events[i])
+        {
+        case 'K':
+            points[POINT_CLE] = i;
+            break;
+        case 'U':
+            points[POINT_CHUTE] = i;
+            break;
+        case 'R':
+            points[POINT_OUBLI] = i;
+            break;
+        case 'S':
+            points[POINT_SORTIE] = i;
+            break;
+        case 'D':
+            porte = i;
+            break;
+        default:
+            continue;
+        }
+        aTrouver--;
+    }
+
+    Trajet trajets[NB_POINTS][NB_POINTS];
+    for (int depart = 0; depart < NB_POINTS; depart++)
+    {
+        for (int arrivee = 0; arrivee < NB_POINTS; arrivee++)
+        {
+            trajets[depart][arrivee] = analyserTrajetCompact(arbre, points, porte, depart, arrivee, NULL);
+        }
+    }
+    int etatInitial = (points[POINT_CHUTE] != AUCUN_NOEUD ? ETAT_CHUTE : 0) | (points[POINT_OUBLI] != AUCUN_NOEUD ? ETAT_OUBLI : 0);
+    int etapes[NB_POINTS * NB_ETATS][2];
+    int nbEtapes;
+    int longueur = chercherParcours(trajets, etatInitial, etapes, &nbEtapes);
+    if (longueur < 0)
+    {
+        solution.raison = raisonSansSolution(trajets);
+        return solution;
+    }
+
+    solution.existe = true;
+    solution.mouvements = malloc((longueur > 0 ? longueur : 1) * sizeof(Touche));
+    if (solution.mouvements == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour la solution");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < nbEtapes; i++)
+    {
+        Trajet trajet = analyserTrajetCompact(arbre, points, porte, etapes[i][0], etapes[i][1], solution.mouvements + solution.nbMouvements);
+        solution.nbMouvements += trajet.longueur;
+    }
+    return solution;
+}
+
+/**
+ * Allocation d'une table creuse de visites vide.
+ * @param visites Les visites.
+ * @param capacite Le nombre de cases, une puissance de 2.
+ */
+static void allouerTableVisites(Visites *visites, uint32_t capacite)
+{
+    visites->cles = malloc(capacite * sizeof(uint32_t));
+    if (visites->cles == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour les visites");
+        exit(EXIT_FAILURE);
+    }
+    memset(visites->cles, 0xFF, capacite * sizeof(uint32_t)); // Toutes les cases à AUCUN_NOEUD
+    visites->capacite = capacite;
+    visites->decalage = 32 - __builtin_ctz(capacite);
+}
+
+/**
+ * Initialisation des visites d'un joueur : aucun nœud visité. La table creuse ne coûte que quelques centaines
+ * d'octets, quelle que soit la taille de l'arbre ; sur un petit arbre, le bitset est plus petit et pris d'emblée.
+ * @param visites Les visites à initialiser.
+ * @param taille Le nombre de nœuds de l'arbre.
+ */
+void initVisites(Visites *visites, uint32_t taille)
+{
+    visites->taille = taille;
+    visites->nombre = 0;
+    visites->capacite = 0;
+    visites->cles = NULL;
+    visites->bits = NULL;
+    if ((taille + 63) / 64 * sizeof(uint64_t) <= CAPACITE_VISITES_MIN * sizeof(uint32_t))
+    {
+        visites->bits = calloc((taille + 63) / 64, sizeof(uint64_t));
+        if (visites->bits == NULL)
+        {
+            perror("Erreur d'allocation mémoire pour les visites");
+            exit(EXIT_FAILURE);
+        }
+    }
+    else
+    {
+        allouerTableVisites(visites, CAPACITE_VISITES_MIN);
+    }
+}
+
+/**
+ * Libération des visites d'un joueur.
+ * @param visites Les visites.
+ */
+void libererVisites(Visites *visites)
+{
+    free(visites->cles);
+    free(visites->bits);
+    visites->cles = NULL;
+    visites->bits = NULL;
+}
+
+/**
+ * Oubli de toutes les visites (salle R, nouvelle partie), en temps constant amorti : une table agrandie ou un bitset
+ * plus grand que la table initiale est libéré, et les visites repartent de la table creuse minimale, comme avec
+ * initVisites. Libérer ne coûte que les pages touchées par des visites, et le bitset n'est recréé qu'après
+ * de nombreuses nouvelles visites : ce sont elles qui paient, au lieu d'un effacement de tout l'arbre à chaque oubli.
+ * Sinon, la table ou le petit bitset est effacé en place, sans nouvelle allocation.
+ * @param visites Les visites.
+ */
+void effacerVisites(Visites *visites)
+{
+    size_t octetsBitset = (visites->taille + 63) / 64 * sizeof(uint64_t);
+    size_t octets = visites->bits != NULL ? octetsBitset : visites->capacite * sizeof(uint32_t);
+    size_t octetsInitiaux = octetsBitset <= CAPACITE_VISITES_MIN * sizeof(uint32_t) ? octetsBitset
+                                                                                   : CAPACITE_VISITES_MIN * sizeof(uint32_t);
+    if (octets > octetsInitiaux)
+    {
+        libererVisites(visites);
+        initVisites(visites, visites->taille);
+        octets = octetsInitiaux;
+    }
+    else if (visites->bits != NULL)
+    {
+        memset(visites->bits, 0, octets);
+    }
+    else
+    {
+        memset(visites->cles, 0xFF, octets);
+    }
+    visites->nombre = 0;
+    if (releves.actives)
+    {
+        releves.octetsEffaces += octets;
+    }
+}
+
+/**
+ * Test de visite d'un nœud.
+ * @param visites Les visites.
+ * @param noeud L'indice du nœud.
+ * @return vrai si le nœud a été visité.
+ */
+static inline bool estVisiteJoueur(const Visites *visites, uint32_t noeud)
+{
+    if (visites->bits != NULL)
+    {
+        return (visites->bits[noeud / 64] >> (noeud % 64)) & 1;
+    }
+    // Sondage linéaire à partir du hachage ; la table est au plus à moitié pleine, une case vide arrête vite
+    uint32_t masque = visites->capacite - 1;
+    for (uint32_t i = (noeud * 0x9E3779B1u) >> visites->decalage;; i = (i + 1) & masque)
+    {
+        if (visites->cles[i] == noeud)
+        {
+            return true;
+        }
+        if (visites->cles[i] == AUCUN_NOEUD)
+        {
+            return false;
+        }
+    }
+}
+
+/**
+ * Passage de la table creuse à une table deux fois plus grande, ou au bitset quand celui-ci serait plus petit.
+ * @param visites Les visites, en mode table creuse.
+ */
+static void agrandirVisites(Visites *visites)
+{
+    uint32_t *anciennes = visites->cles;
+    uint32_t ancienneCapacite = visites->capacite;
+    if ((visites->taille + 63) / 64 * sizeof(uint64_t) <= 2 * (size_t)ancienneCapacite * sizeof(uint32_t))
+    {
+        visites->bits = calloc((visites->taille + 63) / 64, sizeof(uint64_t));
+        if (visites->bits == NULL)
+        {
+            perror("Erreur d'allocation mémoire pour les visites");
+            exit(EXIT_FAILURE);
+        }
+        for (uint32_t i = 0; i < ancienneCapacite; i++)
+        {
+            if (anciennes[i] != AUCUN_NOEUD)
+            {
+                visites->bits[anciennes[i] / 64] |= (uint64_t)1 << (anciennes[i] % 64);
+            }
+        }
+        visites->cles = NULL;
+        visites->capacite = 0;
+    }
+    else
+    {
+        allouerTableVisites(visites, 2 * ancienneCapacite);
+        uint32_t masque = visites->capacite - 1;
+        for (uint32_t i = 0; i < ancienneCapacite; i++)
+        {
+            if (anciennes[i] != AUCUN_NOEUD)
+            {
+                uint32_t j = (anciennes[i] * 0x9E3779B1u) >> visites->decalage;
+                while (visites->cles[j] != AUCUN_NOEUD)
+                {
+                    j = (j + 1) & masque;
+                }
+                visites->cles[j] = anciennes[i];
+            }
+        }
+    }
+    free(anciennes);
+}
+
+/**
+ * Marque un nœud comme visité.
+ * @param visites Les visites.
+ * @param noeud L'indice du nœud.
+ * @return vrai si le nœud n'était pas encore visité.
+ */
+static inline bool marquerVisiteJoueur(Visites *visites, uint32_t noeud)
+{
+    if (visites->bits != NULL)
+    {
+        uint64_t masque = (uint64_t)1 << (noeud % 64);
+        if (visites->bits[noeud / 64] & masque)
+        {
+            return false;
+        }
+        visites->bits[noeud / 64] |= masque;
+        visites->nombre++;
+        return true;
+    }
+    if (estVisiteJoueur(visites, noeud))
+    {
+        return false;
+    }
+    if (2 * (visites->nombre + 1) > visites->capacite)
+    {
+        agrandirVisites(visites);
+        if (visites->bits != NULL)
         {
-            printf("      \n");
+            return marquerVisiteJoueur(visites, noeud);
         }
     }
-    else if (current->suivantD != NULL)
+    uint32_t masque = visites->capacite - 1;
+    uint32_t i = (noeud * 0x9E3779B1u) >> visites->decalage;
+    while (visites->cles[i] != AUCUN_NOEUD)
     {
-        current->suivantD->visite ? printf("              [%c]\n", current->suivantD->event) : printf("              [?]\n");
+        i = (i + 1) & masque;
     }
-    else
+    visites->cles[i] = noeud;
+    visites->nombre++;
+    return true;
+}
+
+/**
+ * Test de visite d'un nœud dans une partie.
+ * @param partie La partie.
+ * @param noeud L'indice du nœud.
+ * @return vrai si le nœud a été visité dans cette partie.
+ */
+static inline bool estVisitePartie(const Partie *partie, uint32_t noeud)
+{
+    return estVisiteJoueur(&partie->visites, noeud);
+}
+
+/**
+ * Marque un nœud comme visité dans une partie, en tenant à jour le nombre de nœuds non explorés.
+ * @param partie La partie.
+ * @param noeud L'indice du nœud.
+ */
+static inline void marquerVisitePartie(Partie *partie, uint32_t noeud)
+{
+    if (marquerVisiteJoueur(&partie->visites, noeud))
     {
-        printf("               \n");
+        partie->nbNonExplores--;
+        compterNonExplores();
     }
+}
 
-    // si on est à la sortie, on affiche pas les choix possibles
-    if (current->event == 'S')
+/**
+ * Application des événements de la salle dans laquelle le joueur vient d'entrer : règles des types d'événements (eventTypes).
+ * Les messages ne sont écrits que si la partie a un tampon ; on compte aussi les événements déclenchés.
+ * @param partie La partie.
+ * @param actions Les actions déjà demandées par la salle quittée.
+ */
+static inline void entrerSallePartie(Partie *partie, int actions)
+{
+    uint32_t salle = partie->current;
+    const EventType *type = typeEvent(partie->arbre->events[salle]);
+    compterDeclenchement(type);
+    if (type->entrer != NULL)
     {
-        return;
+        EtatSalle etat = {estVisitePartie(partie, salle), partie->cleTrouvee, partie->image};
+        actions |= type->entrer(&etat);
     }
-    // Afficher les choix possibles
-    printf("\nChoix possibles:\n");
-    int option = 1;
-    if (current->suivantG != NULL)
+    if (actions & ACTION_OUBLIER)
     {
-        printf("%d. <- pour aller a gauche \n", option++);
+        effacerVisites(&partie->visites);
+        partie->nbNonExplores = partie->arbre->taille;
+        compterNonExplores();
+        partie->nbOublis++;
+        if (releves.actives)
+        {
+            releves.oublis++;
+        }
+    }
+    if (actions & ACTION_CLE)
+    {
+        partie->cleTrouvee = true;
     }
-    if (current->suivantD != NULL)
+    if (!(actions & ACTION_BROUILLARD))
     {
-        printf("%d. -> pour aller a droite \n", option++);
+        marquerVisitePartie(partie, salle);
     }
-    if (current->parent != NULL)
+    partie->type = type;
+    partie->randomMove = (actions & ACTION_ALEATOIRE) != 0;
+    partie->gagnee = (actions & ACTION_SORTIE) != 0;
+    if (actions & ACTION_CHUTE)
     {
-        printf("%d. ^ pour revenir au parent \n", option++);
+        // retour à l'entrée, dont les événements s'appliquent à leur tour
+        partie->current = 0;
+        partie->nbChutes++;
+        entrerSallePartie(partie, 0);
     }
-    printf("%d. Echap pour quitter\n\n", option);
 }
 
 /**
- * Affichage des règles du jeu.
+ * Retour au début de la partie, sans nouvelle allocation.
+ * @param partie La partie.
+ * @param graine La nouvelle graine du générateur de la partie.
+ */
+void recommencerPartie(Partie *partie, uint64_t graine)
+{
+    effacerVisites(&partie->visites);
+    partie->current = 0;
+    partie->arrivee = 0;
+    partie->nbNonExplores = partie->arbre->taille;
+    compterNonExplores();
+    partie->cleTrouvee = false;
+    partie->randomMove = false;
+    partie->gagnee = false;
+    partie->nbMouvements = 0;
+    partie->nbChutes = 0;
+    partie->nbOublis = 0;
+    aleaInit(&partie->alea, graine);
+    entrerSallePartie(partie, 0);
+}
+
+/**
+ * Début d'une partie sur un arbre compact, qui n'est jamais modifié : plusieurs parties,
+ * éventuellement sur des threads différents, peuvent partager le même arbre.
+ * @param partie La partie à initialiser.
+ * @param arbre L'arbre compact (forme et événements).
+ * @param graine La graine du générateur de la partie, pour les mouvements aléatoires de la salle A.
+ */
+void initPartie(Partie *partie, const ArbreCompact *arbre, uint64_t graine)
+{
+    partie->arbre = arbre;
+    partie->image = NULL; // Sans affichage, tant qu'un tampon n'est pas donné
+    initVisites(&partie->visites, arbre->taille);
+    recommencerPartie(partie, graine);
+}
+
+/**
+ * Libération de la mémoire d'une partie (l'arbre n'est pas libéré).
+ * @param partie La partie.
+ */
+void libererPartie(Partie *partie)
+{
+    libererVisites(&partie->visites);
+}
+
+/**
+ * Un tour de jeu : les règles du jeu pour une touche, jouées par toutes les parties (labyrinthe_step).
+ * @param partie La partie.
+ * @param touche La touche jouée ; après la salle A, n'importe quelle touche donne un mouvement aléatoire.
+ * @return vrai si le joueur s'est déplacé.
  */
-void afficherReglesDuJeu()
+bool jouerPartie(Partie *partie, Touche touche)
 {
-    printf("Bienvenue dans le jeu du labyrinthe !\n");
-    printf("Voici les regles du jeu :\n");
-    printf("1. Vous commencez a l'entree du labyrinthe (E).\n");
-    printf("2. Votre objectif est de trouver la sortie (S).\n");
-    printf("3. Vous pouvez vous déplacer vers la gauche ou la droite.\n");
-    printf("4. Faites attention aux différents événements que vous pouvez rencontrer :\n");
+    const ArbreCompact *arbre = partie->arbre;
+    uint32_t current = partie->current;
+    uint32_t cible = AUCUN_NOEUD;
+    if (partie->gagnee)
+    {
+        return false;
+    }
+    const EventType *type = partie->type;
+    EtatSalle salle = {false, partie->cleTrouvee, partie->image}; // dejaVisitee n'est calculé que pour une règle de départ
+    if (partie->randomMove)
+    {
+        // On choisit un mouvement aléatoire, entre parent, gauche et droite (s'ils existent).
+        int i = 0;
+        uint32_t mouvements[3];
+        uint32_t voisins[3] = {parentCompact(arbre, current), gaucheCompact(arbre, current), droiteCompact(arbre, current)};
+        for (int v = 0; v < 3; v++)
+            if (voisins[v] != AUCUN_NOEUD)
+                mouvements[i++] = voisins[v];
+        cible = i > 0 ? mouvements[aleaBorne(&partie->alea, i)] : AUCUN_NOEUD;
+    }
+    else if (touche == TOUCHE_HAUT)
+    {
+        cible = parentCompact(arbre, current);
+    }
+    else if ((touche == TOUCHE_GAUCHE || touche == TOUCHE_DROITE) && type->bloquer != NULL && type->bloquer(&salle))
+    {
+        cible = AUCUN_NOEUD; // La salle (la porte) empêche de descendre
+    }
+    else if (touche == TOUCHE_GAUCHE)
+    {
+        cible = gaucheCompact(arbre, current);
+    }
+    else if (touche == TOUCHE_DROITE)
+    {
+        cible = droiteCompact(arbre, current);
+    }
+    if (cible == AUCUN_NOEUD)
+    {
+        return false;
+    }
 
-    // Afficher les différents événements
-    for (int i = 0; i < sizeof(eventTypes) / sizeof(eventTypes[0]); i++)
+    partie->current = partie->arrivee = cible;
+    partie->nbMouvements++;
+    int actions = 0;
+    if (type->quitter != NULL)
     {
-        printf("   - %c : %s\n", eventTypes[i].letter, eventTypes[i].description);
+        salle.dejaVisitee = estVisitePartie(partie, current);
+        actions = type->quitter(&salle);
     }
+    entrerSallePartie(partie, actions); // La sortie 'S' termine la partie
+    return true;
+}
 
-    printf("5. Les noeuds non explorés sont marqués par un point d'interrogation (?).\n");
-    printf("6. Bonne chance et amusez-vous bien !\n");
+/**
+ * Un tour de jeu, comme jouerPartie, dont le déplacement est ajouté au journal.
+ * @param partie La partie.
+ * @param touche La touche jouée.
+ * @param journal Le journal de la partie, commencé avec la graine de la partie.
+ * @return vrai si le joueur s'est déplacé.
+ */
+bool jouerPartieJournal(Partie *partie, Touche touche, Journal *journal)
+{
+    const ArbreCompact *arbre = partie->arbre;
+    uint32_t depart = partie->current;
+    bool aleatoire = partie->randomMove;
+    if (!jouerPartie(partie, touche))
+    {
+        return false;
+    }
+    journalMouvement(journal,
+                     partie->arrivee == parentCompact(arbre, depart)   ? JOURNAL_HAUT
+                     : partie->arrivee == gaucheCompact(arbre, depart) ? JOURNAL_GAUCHE
+                                                                : JOURNAL_DROITE,
+                     aleatoire);
+    return true;
 }
 
 /**
- * Boucle de jeu.
- * @param arbre L'arbre binaire à parcourir.
+ * Écriture de l'état final d'une partie dans son journal.
+ * @param journal Le journal de la partie.
+ * @param partie La partie.
  */
-void boucleJeu(Arbre *arbre, int debug)
+void terminerJournal(Journal *journal, const Partie *partie)
 {
-    bool cleTrouvee = false; // pour l'event K et D
-    bool randomMove = false; // pour l'event A
-    // Boucle du jeu
-    while (1)
+    journal->profondeur = profondeurCompact(partie->arbre, partie->current);
+    journal->nbNonExplores = partie->nbNonExplores;
+    journal->cleTrouvee = partie->cleTrouvee;
+    journal->gagnee = partie->gagnee;
+}
+
+/**
+ * Rejoue le journal d'une partie avec les règles de jouerPartie, sans affichage.
+ * La partie recommence avec la graine du journal ; chaque code doit donner le déplacement écrit :
+ * un mouvement aléatoire doit être attendu au même moment et le tirage doit donner la même direction.
+ * À la fin, l'état de la partie doit être celui écrit dans le journal.
+ * @param partie Une partie initialisée sur le labyrinthe de la partie journalisée.
+ * @param journal Le journal.
+ * @return true si la partie rejouée suit le journal et finit dans le même état.
+ */
+bool rejouerJournal(Partie *partie, const Journal *journal)
+{
+    static const Touche touches[] = {TOUCHE_HAUT, TOUCHE_GAUCHE, TOUCHE_DROITE};
+    const ArbreCompact *arbre = partie->arbre;
+    recommencerPartie(partie, journal->graine);
+    for (uint64_t i = 0; i < journal->nbCodes; i++)
     {
-        randomMove = false; // réinitialisation
-        // si on visite pour la première fois la salle R
-        if (arbre->current->event == 'R' && arbre->current->visite == false)
+        CodeJournal code = lireCodeJournal(journal, i);
+        bool aleatoire = code == JOURNAL_ALEATOIRE;
+        if (aleatoire)
         {
-            printf("Vous avez perdu la memoire, vous ne savez plus ou vous etes.\n");
-            // on réinitialise toutes les salles visitées en les mettant à false
-            reinitialiserVisite(arbre->premier);
+            if (++i == journal->nbCodes)
+            {
+                return false; // Journal tronqué
+            }
+            code = lireCodeJournal(journal, i);
         }
-
-        // si on visite pour la première fois la salle U
-        if (arbre->current->event == 'U' && arbre->current->visite == false)
+        if (code == JOURNAL_ALEATOIRE || aleatoire != partie->randomMove)
         {
-            printf("Vous tombez de l'arbre ! Retour au debut.\n");
-            arbre->current->visite = true;
-            arbre->current = arbre->premier;
+            return false;
         }
+        uint32_t depart = partie->current;
+        uint32_t attendue = code == JOURNAL_HAUT     ? parentCompact(arbre, depart)
+                            : code == JOURNAL_GAUCHE ? gaucheCompact(arbre, depart)
+                                                     : droiteCompact(arbre, depart);
+        if (!jouerPartie(partie, touches[code]) || partie->arrivee != attendue)
+        {
+            return false;
+        }
+    }
+    return partie->nbMouvements == journal->nbMouvements && partie->nbNonExplores == journal->nbNonExplores &&
+           partie->cleTrouvee == journal->cleTrouvee && partie->gagnee == journal->gagnee &&
+           profondeurCompact(arbre, partie->current) == journal->profondeur;
+}
+
+/**
+ * Sauvegarde d'un journal dans un fichier : un en-tête (EnteteJournal) puis les codes, 4 par octet.
+ * @param journal Le journal.
+ * @param chemin Le chemin du fichier, remplacé s'il existe.
+ * @return true si le fichier a été écrit entièrement.
+ */
+bool sauvegarderJournal(const Journal *journal, const char *chemin)
+{
+    if (!estPetitBoutiste())
+    {
+        fprintf(stderr, "Format de fichier non pris en charge sur une machine gros-boutiste\n");
+        return false;
+    }
+    EnteteJournal entete = {{0}, VERSION_JOURNAL, journal->graine, journal->nbCodes, journal->nbMouvements,
+                            journal->profondeur, journal->nbNonExplores, journal->cleTrouvee, journal->gagnee, {0}};
+    memcpy(entete.magie, MAGIE_JOURNAL, sizeof(entete.magie));
+    FILE *fichier = fopen(chemin, "wb");
+    if (fichier == NULL)
+    {
+        perror("Erreur d'ouverture du fichier de journal");
+        return false;
+    }
+    size_t nbOctets = (journal->nbCodes + 3) / 4;
+    bool ecrit = fwrite(&entete, sizeof(entete), 1, fichier) == 1 &&
+                 fwrite(journal->codes, 1, nbOctets, fichier) == nbOctets;
+    if (fclose(fichier) != 0)
+    {
+        ecrit = false;
+    }
+    if (!ecrit)
+    {
+        perror("Erreur d'écriture du fichier de journal");
+    }
+    return ecrit;
+}
 
-        // si on visite pour la première fois la clé
-        if (arbre->current->event == 'K' && arbre->current->visite == false)
+/**
+ * Lecture d'un journal sauvegardé par sauvegarderJournal.
+ * @param journal Le journal où lire, initialisé à zéro ou déjà utilisé.
+ * @param chemin Le chemin du fichier.
+ * @return true si le fichier est un journal valide et complet.
+ */
+bool chargerJournal(Journal *journal, const char *chemin)
+{
+    if (!estPetitBoutiste())
+    {
+        fprintf(stderr, "Format de fichier non pris en charge sur une machine gros-boutiste\n");
+        return false;
+    }
+    FILE *fichier = fopen(chemin, "rb");
+    if (fichier == NULL)
+    {
+        perror("Erreur d'ouverture du fichier de journal");
+        return false;
+    }
+    EnteteJournal entete;
+    const char *raison = NULL;
+    if (fread(&entete, sizeof(entete), 1, fichier) != 1 || memcmp(entete.magie, MAGIE_JOURNAL, sizeof(entete.magie)) != 0)
+        raison = "ce n'est pas un fichier de journal";
+    else if (entete.version != VERSION_JOURNAL)
+        raison = "version du format non prise en charge";
+    else if (entete.nbCodes < entete.nbMouvements || entete.nbCodes > 2 * (uint64_t)entete.nbMouvements)
+        raison = "nombre de mouvements incohérent";
+    if (raison == NULL)
+    {
+        uint64_t nbOctets = (entete.nbCodes + 3) / 4;
+        if (nbOctets > journal->capacite)
         {
-            printf("Vous trouvez une cle ! Mais ou est la porte ?\n");
-            cleTrouvee = true;
+            uint8_t *codes = realloc(journal->codes, nbOctets);
+            if (codes == NULL)
+            {
+                perror("Erreur d'allocation mémoire pour le journal");
+                exit(EXIT_FAILURE);
+            }
+            journal->codes = codes;
+            journal->capacite = nbOctets;
         }
+        if (fread(journal->codes, 1, nbOctets, fichier) != nbOctets || fgetc(fichier) != EOF)
+            raison = "taille incohérente";
+    }
+    fclose(fichier);
+    if (raison != NULL)
+    {
+        fprintf(stderr, "Fichier de journal invalide (%s) : %s\n", raison, chemin);
+        journal->nbCodes = 0;
+        return false;
+    }
+    journal->graine = entete.graine;
+    journal->nbCodes = entete.nbCodes;
+    journal->nbMouvements = entete.nbMouvements;
+    journal->profondeur = entete.profondeur;
+    journal->nbNonExplores = entete.nbNonExplores;
+    journal->cleTrouvee = entete.cleTrouvee != 0;
+    journal->gagnee = entete.gagnee != 0;
+    return true;
+}
 
-        // si on trouve la porte pour la première fois
-        if (arbre->current->event == 'D' && arbre->current->visite == false)
+/**
+ * Génération d'un labyrinthe compact avec événements, recommencée tant qu'il n'a pas de solution.
+ * @param taille Le nombre de nœuds.
+ * @param algorithme L'algorithme de génération.
+ * @param alea Le générateur pseudo-aléatoire.
+ * @return l'arbre compact généré, le joueur à l'entrée.
+ */
+ArbreCompact *genererLabyrintheCompact(int taille, AlgorithmeGeneration algorithme, Alea *alea)
+{
+    while (1)
+    {
+        ArbreCompact *arbreCompact;
+        if (algorithme == GENERATION_PARALLELE)
+        {
+            // Forme et événements générés sur tous les cœurs
+            Decoupage decoupage;
+            arbreCompact = genererArbreCompactParallele(taille, nombreCoeurs(), alea, &decoupage);
+            genererEventsCompactParallele(arbreCompact, &decoupage, nombreCoeurs(), alea);
+            libererDecoupage(&decoupage);
+        }
+        else
         {
-            if (cleTrouvee)
+            if (algorithme == GENERATION_LINEAIRE)
             {
-                printf("Vous tombez sur une porte fermee a cle, et ca tombe bien, vous avez deja la cle !\n");
+                arbreCompact = genererArbreCompact(taille, alea); // générée directement en représentation compacte
             }
             else
             {
-                printf("Vous tombez sur une porte fermee a cle. Mais ou est la cle pour avancer ?\n");
+                Arbre *arbreSource = init();
+                genererArbre(arbreSource, taille, alea);
+                arbreSource->current = arbreSource->premier;
+                arbreCompact = compacterArbre(arbreSource); // on passe en représentation compacte
+                detruireArbre(arbreSource);                 // l'arbre d'origine n'est plus utile
             }
+            genererEventsCompact(arbreCompact, alea);
         }
-
-        // si on visite la salle B
-        if (arbre->current->event == 'B')
+        Solution solution = resoudreLabyrintheCompact(arbreCompact);
+        libererSolution(&solution);
+        if (solution.existe)
         {
-            printf("Il y a beaucoup de brouillard ici ...\n");
+            return arbreCompact;
         }
+        detruireArbreCompact(arbreCompact);
+    }
+}
+
+/**
+ * Déplacement dans un fichier qui peut dépasser 4 Go.
+ * @param fichier Le fichier.
+ * @param position La position, en octets depuis le début.
+ * @return true si le déplacement a réussi.
+ */
+static bool deplacerFichier(FILE *fichier, uint64_t position)
+{
+#ifdef _WIN32
+    return _fseeki64(fichier, (__int64)position, SEEK_SET) == 0;
+#else
+    return fseeko(fichier, (off_t)position, SEEK_SET) == 0;
+#endif
+}
 
-        // si on visite pour la première fois la salle A
-        if (arbre->current->event == 'A' && arbre->current->visite == false)
+/**
+ * Ajout d'un nœud à un échantillon tiré uniformément et sans remise parmi tous les nœuds vus (algorithme R) :
+ * le k-ième nœud vu remplace une case tirée au hasard avec une probabilité taille / k.
+ * @param echantillon L'échantillon.
+ * @param taille La taille de l'échantillon.
+ * @param nbVus Le nombre de nœuds déjà vus, mis à jour.
+ * @param noeud Le nœud vu.
+ * @param alea Le générateur pseudo-aléatoire.
+ */
+static inline void echantillonner(uint32_t *echantillon, uint32_t taille, uint32_t *nbVus, uint32_t noeud, Alea *alea)
+{
+    uint32_t vus = ++*nbVus;
+    if (vus <= taille)
+    {
+        echantillon[vus - 1] = noeud;
+    }
+    else
+    {
+        uint32_t place = aleaBorne(alea, vus);
+        if (place < taille)
         {
-            printf("Tu es desoriente, ton prochain mouvement sera aleatoire.\n");
-            randomMove = true;
+            echantillon[place] = noeud;
         }
+    }
+}
+
+/**
+ * Mélange d'un échantillon, pour que l'ordre de ses éléments soit lui aussi uniforme.
+ * @param echantillon L'échantillon.
+ * @param taille Le nombre d'éléments.
+ * @param alea Le générateur pseudo-aléatoire.
+ */
+static void melangerEchantillon(uint32_t *echantillon, uint32_t taille, Alea *alea)
+{
+    for (uint32_t i = taille; i > 1; i--)
+    {
+        uint32_t j = aleaBorne(alea, i);
+        uint32_t temp = echantillon[i - 1];
+        echantillon[i - 1] = echantillon[j];
+        echantillon[j] = temp;
+    }
+}
 
-        // on met le noeud actuel en visité, sauf si c'est un brouillard
-        if (arbre->current->event != 'B')
+/**
+ * Écriture de nœuds consécutifs (en ordre préfixe) dans le fichier en cours de génération.
+ * Chaque nœud est proposé aux tirages de la sortie, de la porte et des autres événements,
+ * qui sont placés une fois tout le fichier écrit.
+ * @param generation La génération en cours.
+ * @param gauche Les fils gauches des nœuds.
+ * @param droite Les fils droits des nœuds.
+ * @param parent Les parents des nœuds.
+ * @param events Les événements des nœuds ('E', 'K' ou 'X').
+ * @param profondeurs Les profondeurs des nœuds (la racine a la profondeur 1).
+ * @param nombre Le nombre de nœuds.
+ */
+static void ecrireNoeuds(GenerationFichier *generation, const uint32_t *gauche, const uint32_t *droite,
+                         const uint32_t *parent, const char *events, const uint32_t *profondeurs, uint32_t nombre)
+{
+    for (uint32_t i = 0; i < nombre; i++)
+    {
+        uint32_t noeud = generation->position + i;
+        if (events[i] != 'X') // L'entrée et la clé ne reçoivent rien d'autre
+        {
+            continue;
+        }
+        if (gauche[i] == AUCUN_NOEUD && droite[i] == AUCUN_NOEUD)
+        {
+            echantillonner(&generation->sortie, 1, &generation->nbFeuilles, noeud, generation->alea);
+        }
+        if (profondeurs[i] > generation->profondeurCle)
         {
-            arbre->current->visite = true;
+            echantillonner(generation->porte, 2, &generation->nbCandidatsPorte, noeud, generation->alea);
         }
+        echantillonner(generation->autres, generation->nbAutres, &generation->nbCandidatsAutres, noeud, generation->alea);
+    }
+    fwrite(gauche, sizeof(uint32_t), nombre, generation->fichiers[0]);
+    fwrite(droite, sizeof(uint32_t), nombre, generation->fichiers[1]);
+    fwrite(parent, sizeof(uint32_t), nombre, generation->fichiers[2]);
+    fwrite(events, 1, nombre, generation->fichiers[3]);
+    generation->position += nombre;
+}
+
+/**
+ * Construction d'un sous-arbre d'un découpage dans un tampon, avec les profondeurs de ses nœuds.
+ * @param decoupage Le découpage.
+ * @param j Le numéro du sous-arbre.
+ * @param flux Les flux pseudo-aléatoires des sous-arbres.
+ * @param tampon Les tableaux gauche, droite, parent et profondeurs du tampon (tampon[0] à tampon[3]).
+ * @param events Les événements du tampon.
+ */
+static void construireSousArbreTampon(const Decoupage *decoupage, uint32_t j, const Alea *flux, uint32_t *tampon[4],
+                                      char *events)
+{
+    uint32_t debut = decoupage->debut[j];
+    uint32_t taille = decoupage->taille[j];
+    Alea alea = flux[j];
+    uint32_t nbFeuilles, feuille;
+    construireArbreRemy(tampon[0], tampon[1], tampon[2], events, debut, taille, decoupage->colonne[j], &alea,
+                        &nbFeuilles, &feuille);
+    for (uint32_t i = 0; i < taille; i++)
+    {
+        tampon[3][i] = i == 0 ? j + 2 : tampon[3][tampon[2][i] - debut] + 1; // Le nœud j de la colonne a la profondeur j + 1
+    }
+}
+
+/**
+ * Écriture d'un labyrinthe dans un fichier, au format de sauvegarderLabyrinthe, sans jamais le garder en mémoire.
+ * La forme est celle de genererArbreCompactParallele : une colonne de nœuds qui portent des sous-arbres de Rémy.
+ * Les nœuds sont écrits dans l'ordre préfixe, un sous-arbre à la fois : un sous-arbre à gauche suit son nœud
+ * de la colonne, un sous-arbre à droite est mis de côté (seulement son numéro) et écrit après le reste de la colonne.
+ * Chaque sous-arbre ayant son propre flux pseudo-aléatoire, il peut être construit au moment où il est écrit.
+ * La clé est placée avant l'écriture, le chemin le plus à gauche ne passant que par le début de la colonne et le premier
+ * sous-arbre à gauche, construit en premier. Le nombre d'occurrences des autres événements est tiré d'avance
+ * avec leurs poids et leurs quotas (tirerNombresEvents). La sortie, la porte et les nœuds de ces événements sont
+ * tirés pendant l'écriture par échantillonnage, puis écrits à leur place à la fin, comme dans l'en-tête.
+ * Pour une même graine, la forme est exactement celle de genererArbreCompactParallele, découpage compris.
+ * La mémoire utilisée ne dépend que du nombre de sous-arbres (quelques octets chacun, MAX_SOUS_ARBRES au plus)
+ * et de la taille d'un sous-arbre : TAILLE_SOUS_ARBRE, puis nombre / MAX_SOUS_ARBRES au-delà de
+ * MAX_SOUS_ARBRES * TAILLE_SOUS_ARBRE nœuds (quelques millions de nœuds au plus, pour des indices sur 32 bits).
+ * @param nombre Le nombre de nœuds, au moins 2 * TAILLE_SOUS_ARBRE.
+ * @param chemin Le chemin du fichier, remplacé s'il existe.
+ * @param alea Le générateur pseudo-aléatoire.
+ * @return true si le fichier a été écrit entièrement.
+ */
+static bool ecrireLabyrintheFichier(uint32_t nombre, const char *chemin, Alea *alea)
+{
+    uint32_t nbSousArbres = nombre / TAILLE_SOUS_ARBRE;
+    if (nbSousArbres > MAX_SOUS_ARBRES) // Même découpage que genererArbreCompactParallele, donc même forme
+    {
+        nbSousArbres = MAX_SOUS_ARBRES;
+    }
+    Alea *flux = fluxSousArbres(alea, nbSousArbres);
+    Decoupage decoupage;
+    decouperArbre(nombre, nbSousArbres, alea, &decoupage);
+
+    // Tampon d'un sous-arbre, le premier étant le plus grand
+    uint32_t capacite = decoupage.taille[0];
+    uint32_t *tampon[4];
+    for (int k = 0; k < 4; k++)
+    {
+        tampon[k] = malloc(capacite * sizeof(uint32_t));
+    }
+    char *events = malloc(capacite);
+    uint32_t *pile = malloc(nbSousArbres * sizeof(uint32_t)); // Sous-arbres à droite mis de côté
+    if (tampon[0] == NULL || tampon[1] == NULL || tampon[2] == NULL || tampon[3] == NULL || events == NULL ||
+        pile == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour la génération dans un fichier");
+        exit(EXIT_FAILURE);
+    }
 
-        // on affiche le nombre de noeuds restants
-        printf("\nIl reste " RED "%d" RESET " noeuds non explores\n\n", compterNoeudsNonExplores(arbre->premier));
+    // Le chemin le plus à gauche descend la colonne jusqu'au premier sous-arbre à gauche, puis le suit
+    uint32_t premier = 0;
+    while (premier + 1 < nbSousArbres && decoupage.debut[premier] != decoupage.colonne[premier] + 1)
+    {
+        premier++;
+    }
+    construireSousArbreTampon(&decoupage, premier, flux, tampon, events);
+    uint32_t longueurChemin = premier + 1;
+    for (uint32_t n = decoupage.debut[premier]; n != AUCUN_NOEUD;)
+    {
+        uint32_t i = n - decoupage.debut[premier]; // Indice dans le tampon
+        longueurChemin++;
+        n = tampon[0][i] != AUCUN_NOEUD ? tampon[0][i] : tampon[1][i];
+    }
 
-        if (debug)
+    GenerationFichier generation = {{NULL, NULL, NULL, NULL}, 0, AUCUN_NOEUD, AUCUN_NOEUD, 0, AUCUN_NOEUD, 0,
+                                    {AUCUN_NOEUD, AUCUN_NOEUD}, 0, 0, NULL, alea};
+    uint32_t keyIndex = 0;
+    if (longueurChemin >= 3)
+    {
+        keyIndex = 1 + aleaBorne(alea, longueurChemin - 2);
+        generation.profondeurCle = keyIndex;
+        if (keyIndex <= premier)
         {
-            afficherArbre(arbre->premier, 0, arbre->current);
-            // on affiche les mouvements possibles
-            printf("\nChoix possibles:\n");
-            int option = 1;
-            if (arbre->current->suivantG != NULL)
-            {
-                printf("%d. <- pour aller a gauche \n", option++);
-            }
-            if (arbre->current->suivantD != NULL)
-            {
-                printf("%d. -> pour aller a droite \n", option++);
-            }
-            if (arbre->current->parent != NULL)
+            generation.cle = decoupage.colonne[keyIndex];
+        }
+        else
+        {
+            uint32_t n = 0; // Indice dans le tampon
+            for (uint32_t i = premier + 1; i < keyIndex; i++)
             {
-                printf("%d. ^ pour revenir au parent \n", option++);
+                n = (tampon[0][n] != AUCUN_NOEUD ? tampon[0][n] : tampon[1][n]) - decoupage.debut[premier];
             }
-            printf("%d. Echap pour quitter\n\n", option);
+            generation.cle = decoupage.debut[premier] + n;
+            events[n] = 'K';
         }
-        else
+    }
+
+    // Autres événements : leurs nombres sont tirés comme par tirerEvents sur les nœuds standards qui resteront
+    // (sans l'entrée, la clé, la sortie et la porte), puis il faut autant de candidats, plus deux au cas où
+    // la sortie ou la porte en fasse partie. L'échantillon doit rester petit : une table d'événements qui
+    // demande des occurrences sans limite pour un autre type que le nœud standard est refusée.
+    uint64_t nombres[NB_TYPES_EVENTS];
+    uint32_t nbStandards = nombre - 1 - (generation.cle != AUCUN_NOEUD ? 2 : 0) - 1;
+    tirerNombresEvents(nombres, nbStandards, alea);
+    uint64_t nbAutres = 0;
+    for (size_t j = 0; j < NB_TYPES_EVENTS; j++)
+    {
+        if (eventTypes[j].letter != 'X')
+        {
+            nbAutres += nombres[j];
+        }
+    }
+    if (nbAutres > TAILLE_SOUS_ARBRE)
+    {
+        fprintf(stderr, "Trop d'événements (%llu) pour une génération en mémoire bornée : "
+                        "seul le nœud standard peut être sans limite\n", (unsigned long long)nbAutres);
+        free(pile);
+        free(events);
+        for (int k = 0; k < 4; k++)
         {
-            afficherArbreJoueur(arbre);
+            free(tampon[k]);
         }
-        // si on visite pour la première fois la salle A
-        if (randomMove)
+        free(flux);
+        libererDecoupage(&decoupage);
+        return false;
+    }
+    generation.nbAutres = (uint32_t)nbAutres + 2;
+    generation.autres = malloc(generation.nbAutres * sizeof(uint32_t));
+    if (generation.autres == NULL)
+    {
+        perror("Erreur d'allocation mémoire pour les événements");
+        exit(EXIT_FAILURE);
+    }
+
+    // Un flux par tableau, chacun écrit dans l'ordre à partir de sa place dans le fichier
+    EnteteFichier entete = {{0}, VERSION_FICHIER, sizeof(EnteteFichier), nombre, AUCUN_NOEUD, AUCUN_NOEUD, AUCUN_NOEUD, 0};
+    memcpy(entete.magie, MAGIE_FICHIER, sizeof(entete.magie));
+    bool ecrit = estPetitBoutiste();
+    for (int k = 0; k < 4 && ecrit; k++)
+    {
+        generation.fichiers[k] = fopen(chemin, k == 0 ? "wb" : "r+b");
+        ecrit = generation.fichiers[k] != NULL && setvbuf(generation.fichiers[k], NULL, _IOFBF, 1 << 20) == 0 &&
+                (k == 0 ? fwrite(&entete, sizeof(entete), 1, generation.fichiers[0]) == 1
+                        : deplacerFichier(generation.fichiers[k], sizeof(entete) + (uint64_t)k * nombre * sizeof(uint32_t)));
+        if (k == 0 && ecrit)
         {
-            int ch = getch();
-            // On choisit un mouvement aléatoire, entre parent, gauche et droite (s'ils existent).
-            int i = 0;
-            Element *mouvements[3]; // Tableau pour stocker les mouvements possibles
-            if (arbre->current->parent != NULL)
-            {                                             // Si le parent existe
-                mouvements[i++] = arbre->current->parent; // On l'ajoute
-            }
-            if (arbre->current->suivantG != NULL)
-            {                                               // Si le nœud gauche existe
-                mouvements[i++] = arbre->current->suivantG; // On l'ajoute
-            }
-            if (arbre->current->suivantD != NULL)
-            {                                               // Si le nœud droit existe
-                mouvements[i++] = arbre->current->suivantD; // On l'ajoute
-            }
-            arbre->current = mouvements[rand() % i]; // On choisit un mouvement aléatoire parmi les mouvements possibles
+            fflush(generation.fichiers[0]); // Le fichier doit exister avant d'être rouvert
         }
-        else
+    }
+
+    if (ecrit)
+    {
+        uint32_t sommet = 0;
+        for (uint32_t j = 0; j < nbSousArbres; j++)
         {
-            printf("Utilisez les fleches pour naviguer, Echap pour quitter.\n\n");
-            int ch = getch();
-            if (ch == 0 || ch == 224)
+            // Nœud j de la colonne, puis son sous-arbre s'il est à gauche
+            uint32_t noeud[3];
+            uint32_t profondeur = j + 1;
+            char event = j == 0 ? 'E' : decoupage.colonne[j] == generation.cle ? 'K' : 'X';
+            lierColonne(&decoupage, j, &noeud[0], &noeud[1], &noeud[2]);
+            ecrireNoeuds(&generation, &noeud[0], &noeud[1], &noeud[2], &event, &profondeur, 1);
+            if (decoupage.debut[j] == decoupage.colonne[j] + 1)
             {
-                // Touches spéciales (flèches)
-                ch = getch();
-                switch (ch)
+                if (j != premier)
                 {
-                case 72: // Fleche haut
-                    if (arbre->current->parent != NULL)
-                    {
-                        arbre->current = arbre->current->parent;
-                    }
-                    else
-                    {
-                        printf("Pas de parent.\n");
-                    }
-                    break;
-                case 75: // Fleche gauche
-                    if (arbre->current->event == 'D' && cleTrouvee == false)
-                    {
-                        printf("La porte est fermée à cle, vous ne pouvez pas passer.\n");
-                    }
-                    else if (arbre->current->suivantG != NULL)
-                    {
-                        arbre->current = arbre->current->suivantG;
-                    }
-                    else
-                    {
-                        printf("Pas de noeud gauche.\n");
-                    }
-                    break;
-                case 77: // Fleche droite
-                    if (arbre->current->event == 'D' && cleTrouvee == false)
-                    {
-                        printf("La porte est fermee a cle, vous ne pouvez pas passer.\n");
-                    }
-                    else if (arbre->current->suivantD != NULL)
-                    {
-                        arbre->current = arbre->current->suivantD;
-                    }
-                    else
-                    {
-                        printf("Pas de noeud droit.\n");
-                    }
-                    break;
-                default:
-                    // Autres touches ignorees
-                    break;
+                    construireSousArbreTampon(&decoupage, j, flux, tampon, events);
                 }
+                ecrireNoeuds(&generation, tampon[0], tampon[1], tampon[2], events, tampon[3], decoupage.taille[j]);
             }
-            else if (ch == 27)
+            else
             {
-                // Touche Echap pour quitter
-                printf("Vous avez quitte le jeu.\n");
-                getch(); // Attendre une touche pour quitter
-                break;
+                pile[sommet++] = j;
             }
         }
-        // Vérifier si le joueur a atteint la sortie
-        if (arbre->current->event == 'S')
+        while (sommet > 0) // Les sous-arbres à droite, du plus profond au moins profond
         {
-            system("cls");
-            printf("Felicitations ! Vous avez trouve la sortie.\n");
-            arbre->current->visite = true;
-            printf("Il restait %d noeuds non explores.\n", compterNoeudsNonExplores(arbre->premier));
-            if (debug)
+            uint32_t j = pile[--sommet];
+            if (j != premier)
             {
-                afficherArbre(arbre->premier, 0, arbre->current);
+                construireSousArbreTampon(&decoupage, j, flux, tampon, events);
             }
-            else
+            ecrireNoeuds(&generation, tampon[0], tampon[1], tampon[2], events, tampon[3], decoupage.taille[j]);
+        }
+
+        // Porte et autres événements, en évitant la sortie
+        melangerEchantillon(generation.porte, generation.nbCandidatsPorte < 2 ? generation.nbCandidatsPorte : 2, alea);
+        entete.sortie = generation.sortie;
+        entete.cle = generation.cle;
+        for (uint32_t i = 0; i < 2 && i < generation.nbCandidatsPorte && entete.porte == AUCUN_NOEUD; i++)
+        {
+            if (generation.porte[i] != entete.sortie)
+            {
+                entete.porte = generation.porte[i];
+            }
+        }
+        uint32_t nbEchantillon = generation.nbCandidatsAutres < generation.nbAutres ? generation.nbCandidatsAutres : generation.nbAutres;
+        melangerEchantillon(generation.autres, nbEchantillon, alea);
+
+        FILE *fichierEvents = generation.fichiers[3];
+        uint64_t debutEvents = sizeof(entete) + 3 * (uint64_t)nombre * sizeof(uint32_t);
+        ecrit = deplacerFichier(fichierEvents, debutEvents + entete.sortie) && fputc('S', fichierEvents) != EOF;
+        if (entete.cle != AUCUN_NOEUD && entete.porte == AUCUN_NOEUD) // Sans porte possible, la clé redevient standard
+        {
+            ecrit = ecrit && deplacerFichier(fichierEvents, debutEvents + entete.cle) && fputc('X', fichierEvents) != EOF;
+            entete.cle = AUCUN_NOEUD;
+        }
+        if (entete.porte != AUCUN_NOEUD)
+        {
+            ecrit = ecrit && deplacerFichier(fichierEvents, debutEvents + entete.porte) && fputc('D', fichierEvents) != EOF;
+        }
+        uint32_t suivant = 0;
+        for (size_t j = 0; j < NB_TYPES_EVENTS; j++)
+        {
+            if (eventTypes[j].letter == 'X')
+                continue;
+            for (uint64_t k = 0; k < nombres[j]; k++)
             {
-                afficherArbreJoueur(arbre);
+                while (suivant < nbEchantillon &&
+                       (generation.autres[suivant] == entete.sortie || generation.autres[suivant] == entete.porte))
+                {
+                    suivant++;
+                }
+                if (suivant < nbEchantillon)
+                {
+                    ecrit = ecrit && deplacerFichier(fichierEvents, debutEvents + generation.autres[suivant++]) &&
+                            fputc(eventTypes[j].letter, fichierEvents) != EOF;
+                }
             }
-            getch(); // Attendre une touche pour quitter
-            system("cls");
-            break; // Sortir de la boucle
         }
-        // on clear la console
-        system("cls");
+        ecrit = ecrit && deplacerFichier(generation.fichiers[0], 0) &&
+                fwrite(&entete, sizeof(entete), 1, generation.fichiers[0]) == 1;
+    }
+    for (int k = 0; k < 4; k++)
+    {
+        if (generation.fichiers[k] != NULL && (ferror(generation.fichiers[k]) || fclose(generation.fichiers[k]) != 0))
+        {
+            ecrit = false;
+        }
+    }
+    if (!ecrit)
+    {
+        perror("Erreur d'écriture du fichier de labyrinthe");
+    }
+
+    free(generation.autres);
+    free(pile);
+    free(events);
+    for (int k = 0; k < 4; k++)
+    {
+        free(tampon[k]);
+    }
+    free(flux);
+    libererDecoupage(&decoupage);
+    return ecrit;
+}
+
+/**
+ * Génération d'un labyrinthe directement dans un fichier, recommencée tant qu'il n'a pas de solution.
+ * Les grands labyrinthes sont écrits au fil de leur génération (voir ecrireLabyrintheFichier) : ils peuvent
+ * être plus grands que la mémoire, puis être ouverts avec ouvrirLabyrinthe et résolus sans être chargés.
+ * Les petits sont générés en mémoire puis sauvegardés.
+ * @param nombre Le nombre de nœuds.
+ * @param chemin Le chemin du fichier, remplacé s'il existe.
+ * @param alea Le générateur pseudo-aléatoire.
+ * @return true si le fichier a été écrit.
+ */
+bool genererLabyrintheFichier(uint32_t nombre, const char *chemin, Alea *alea)
+{
+    while (1)
+    {
+        if (nombre < 2 * TAILLE_SOUS_ARBRE)
+        {
+            ArbreCompact *arbre = genererLabyrintheCompact(nombre, GENERATION_LINEAIRE, alea);
+            bool ecrit = sauvegarderLabyrinthe(arbre, chemin);
+            detruireArbreCompact(arbre);
+            return ecrit;
+        }
+        double debutNs = debutChrono();
+        bool ecrit = ecrireLabyrintheFichier(nombre, chemin, alea);
+        finChrono(CHRONO_GENERER_FICHIER, debutNs);
+        if (!ecrit)
+        {
+            return false;
+        }
+        ArbreCompact *arbre = ouvrirLabyrinthe(chemin);
+        if (arbre == NULL)
+        {
+            return false;
+        }
+        Solution solution = resoudreLabyrintheCompact(arbre);
+        libererSolution(&solution);
+        detruireArbreCompact(arbre);
+        if (solution.existe)
+        {
+            return true;
+        }
     }
 }
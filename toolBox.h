@@ -4,11 +4,29 @@
  *
  * Ce fichier contient les déclarations des fonctions et des structures de données utilisées dans le jeu du labyrinthe.
  * Il inclut les définitions des structures `Element` et `Arbre`, ainsi que les déclarations des fonctions utilitaires.
+ * Ce sont les structures internes du moteur : les programmes passent par labyrinthe.h.
  *
  * Les structures principales incluent :
+ * - Alea : Générateur pseudo-aléatoire reproductible, avec des flux indépendants pour les threads.
  * - Element : Représente un nœud de l'arbre binaire.
  * - Arbre : Représente l'arbre binaire.
- * - EventType : Représente un type d'événement dans le jeu.
+ * - BlocArene : Bloc contigu de nœuds appartenant à un arbre.
+ * - ArbreCompact : Représentation compacte de l'arbre, par indices, pour les grands labyrinthes.
+ * - EnteteFichier : En-tête d'un labyrinthe sauvegardé dans un fichier.
+ * - Decoupage : Sous-arbres d'un arbre compact généré sur plusieurs cœurs.
+ * - TravailParallele : Tâches réparties entre plusieurs threads.
+ * - ConstructionParallele : Données partagées par les threads qui génèrent un arbre compact.
+ * - GenerationFichier : Génération d'un labyrinthe directement dans un fichier, en mémoire bornée.
+ * - EventType : Représente un type d'événement dans le jeu, avec ses règles.
+ * - EtatSalle : Salle vue par les règles d'un événement.
+ * - TirageEvents : Tirage pondéré des événements en temps constant, avec quotas.
+ * - Touche : Mouvement demandé au moteur, sur le modèle des touches du jeu.
+ * - Trajet : Chemin dans l'arbre entre deux salles remarquables, pour le solveur.
+ * - Solution : Plus court parcours jusqu'à la sortie, ou raison de son absence.
+ * - Visites : Salles visitées par un joueur, en table creuse tant qu'il en a vu peu, puis en bitset.
+ * - Partie : État d'une partie, sur un arbre compact partagé ; les messages sont facultatifs.
+ * - Journal : Graine et mouvements d'une partie, pour la rejouer à l'identique.
+ * - Releves : Compteurs et temps des chemins chauds, relevés avec l'option --stats.
  *
  * @note Ce projet a été créé par Tony Evrard le 12/12/2024.
  * @note Utilisation du compilateur GCC.
@@ -17,45 +35,354 @@
 #ifndef TOOLBOX_H
 #define TOOLBOX_H
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
 
-// Couleurs pour l'affichage
-#define GREEN "\033[1;32m"
-#define RED "\033[1;31m"
-#define RESET "\033[0m"
+#include "tampon.h"
+
+typedef struct Alea // Générateur pseudo-aléatoire xoshiro256**, dont l'état appartient à l'appelant
+{
+    uint64_t s[4]; // État du générateur, jamais entièrement nul
+} Alea;
 
 typedef struct Element // Structure d'un élément de l'arbre
 {
     struct Element *suivantG; // Pointeur vers le fils gauche
     struct Element *suivantD; // Pointeur vers le fils droit
     struct Element *parent;   // Pointeur vers le parent
-    bool visite;              // Indique si le nœud a été visité
+    unsigned int visite;      // Époque de la dernière visite (visité si égale à l'époque de l'arbre)
     char event;               // Type d'événement associé au nœud
 } Element;
 
+// Capacité du premier bloc de l'arène, les blocs suivants doublent de taille
+#define TAILLE_BLOC_ARENE 64
+
+typedef struct BlocArene // Bloc contigu de nœuds distribués par l'arène
+{
+    struct BlocArene *precedent; // Bloc alloué avant celui-ci
+    int capacite;                // Nombre de nœuds que le bloc peut contenir
+    int utilises;                // Nombre de nœuds déjà distribués
+    Element elements[];          // Les nœuds eux-mêmes
+} BlocArene;
+
 typedef struct Arbre // Structure de l'arbre binaire
 {
     Element *premier; // Pointeur vers le premier nœud de l'arbre
     Element *current; // Pointeur vers le nœud actuel du joueur
+    BlocArene *arene; // Dernier bloc de nœuds alloué pour l'arbre
+    int nbNoeuds;      // Nombre de nœuds de l'arbre
+    int nbNonExplores; // Nombre de nœuds non visités, tenu à jour à chaque changement de visite
+    unsigned int epoque; // Époque courante, l'incrémenter fait oublier toutes les visites
 } Arbre;
 
+typedef enum AlgorithmeGeneration // Algorithme utilisé pour générer la forme de l'arbre
+{
+    GENERATION_DESCENTE, // Descente aléatoire depuis la racine pour chaque nœud (genererArbre)
+    GENERATION_LINEAIRE, // Algorithme de Rémy, en temps linéaire (genererArbreCompact)
+    GENERATION_PARALLELE // Sous-arbres de Rémy construits sur tous les cœurs (genererArbreCompactParallele)
+} AlgorithmeGeneration;
+
+// Indice utilisé dans ArbreCompact pour un nœud absent
+#define AUCUN_NOEUD UINT32_MAX
+
+typedef struct ArbreCompact // Arbre stocké sous forme de tableaux parallèles (13 octets et 1 bit par nœud)
+{
+    uint32_t taille;  // Nombre de nœuds de l'arbre
+    uint32_t *gauche; // Indice du fils gauche de chaque nœud
+    uint32_t *droite; // Indice du fils droit de chaque nœud
+    uint32_t *parent; // Indice du parent de chaque nœud
+    char *events;     // Événement associé à chaque nœud
+    uint64_t *visite; // Bitset des nœuds visités
+    uint32_t current; // Indice du nœud actuel du joueur
+    uint32_t nbNonExplores; // Nombre de nœuds non visités
+    void *projection;       // Fichier ouvert qui contient les tableaux, NULL s'ils ont été alloués un par un
+    size_t tailleProjection; // Taille du fichier ouvert, en octets
+} ArbreCompact;
+
+// Fichier de labyrinthe : l'en-tête, puis les tableaux gauche, droite, parent (uint32_t petit-boutistes) et events
+#define MAGIE_FICHIER "LABY"
+#define VERSION_FICHIER 1
+
+typedef enum FormatExport // Format d'export d'un labyrinthe pour les outils externes
+{
+    EXPORT_DOT, // Graphe GraphViz : un nœud et une arête par salle
+    EXPORT_JSON // JSON lines : un objet par salle et par ligne
+} FormatExport;
+
+// Octets accumulés avant chaque écriture d'un export
+#define TAILLE_LOT_EXPORT 65536
+
+typedef struct EnteteFichier // En-tête d'un fichier de labyrinthe (voir sauvegarderLabyrinthe)
+{
+    char magie[4];        // MAGIE_FICHIER, sans zéro final
+    uint32_t version;     // Version du format, VERSION_FICHIER
+    uint32_t tailleEntete; // Taille de l'en-tête en octets : les tableaux commencent juste après
+    uint32_t taille;      // Nombre de nœuds
+    uint32_t sortie;      // Indice de la sortie 'S'
+    uint32_t cle;         // Indice de la clé 'K', AUCUN_NOEUD s'il n'y en a pas
+    uint32_t porte;       // Indice de la porte 'D', AUCUN_NOEUD s'il n'y en a pas
+    uint32_t reserve;     // Toujours 0, garde les tableaux alignés sur 8 octets
+} EnteteFichier;
+
+// Nombre de nœuds visé pour chaque sous-arbre construit par un thread
+#define TAILLE_SOUS_ARBRE 65536
+// Plus grand arbre construit d'un seul bloc par construireArbreRemy : ses cases (4 * nombre + 2) tiennent sur 32 bits
+#define TAILLE_MAX_REMY ((1u << 30) - 1)
+// Nombre maximum de sous-arbres, donc de nœuds de la colonne
+#define MAX_SOUS_ARBRES 1024
+
+typedef struct Decoupage // Découpage d'un arbre compact généré en parallèle
+{
+    uint32_t nbSousArbres; // Nombre de sous-arbres (0 si l'arbre a été généré d'un seul bloc)
+    uint32_t *colonne;     // Indice du nœud de la colonne qui porte chaque sous-arbre, à la profondeur numéro + 1
+    uint32_t *debut;       // Indice de la racine de chaque sous-arbre, ses nœuds se suivent en ordre préfixe
+    uint32_t *taille;      // Nombre de nœuds de chaque sous-arbre
+} Decoupage;
+
+typedef struct TravailParallele // Tâches numérotées réparties entre plusieurs threads
+{
+    void (*tache)(void *contexte, uint32_t numero); // Fonction qui exécute une tâche
+    void *contexte;                                 // Données partagées par toutes les tâches
+    uint32_t nbTaches;                              // Nombre de tâches
+    _Atomic uint32_t prochaine;                     // Numéro de la prochaine tâche à prendre
+} TravailParallele;
+
+typedef struct ConstructionParallele // Données partagées pendant la génération d'un arbre en parallèle
+{
+    ArbreCompact *arbre;        // Arbre en construction, chaque sous-arbre n'écrit que ses propres indices
+    const Decoupage *decoupage; // Place et taille de chaque sous-arbre
+    const Alea *flux;           // Générateur indépendant de chaque sous-arbre
+    uint32_t *nbFeuilles;       // Nombre de feuilles de chaque sous-arbre
+    uint32_t *feuille;          // Feuille tirée au hasard dans chaque sous-arbre
+    uint32_t profondeurCle;     // Profondeur de la clé, pour compter les nœuds candidats pour la porte
+    uint32_t *nbCandidats;      // Nombre de nœuds candidats pour la porte dans chaque sous-arbre
+} ConstructionParallele;
+
+typedef struct GenerationFichier // État d'un labyrinthe écrit nœud par nœud dans un fichier, sans être gardé en mémoire
+{
+    FILE *fichiers[4];          // Un flux par tableau du fichier : gauche, droite, parent et events
+    uint32_t position;          // Indice du prochain nœud écrit, en ordre préfixe
+    uint32_t cle;               // Indice de la clé, AUCUN_NOEUD s'il n'y en a pas
+    uint32_t profondeurCle;     // Les candidats pour la porte sont plus profonds (AUCUN_NOEUD : pas de porte)
+    uint32_t nbFeuilles;        // Nombre de feuilles écrites
+    uint32_t sortie;            // Feuille tirée uniformément parmi celles déjà écrites
+    uint32_t nbCandidatsPorte;  // Nombre de candidats pour la porte déjà écrits
+    uint32_t porte[2];          // Deux candidats tirés sans remise, pour éviter la sortie
+    uint32_t nbCandidatsAutres; // Nombre de candidats pour les autres événements déjà écrits
+    uint32_t nbAutres;          // Taille de l'échantillon des autres événements
+    uint32_t *autres;           // Candidats tirés sans remise pour les autres événements
+    Alea *alea;                 // Générateur de la forme et des événements
+} GenerationFichier;
+
+typedef enum Touche // Mouvements reconnus par le moteur, sur le modèle des touches du jeu
+{
+    TOUCHE_AUTRE,
+    TOUCHE_HAUT,
+    TOUCHE_BAS,
+    TOUCHE_GAUCHE,
+    TOUCHE_DROITE,
+    TOUCHE_ECHAP
+} Touche;
+
+typedef enum PointRemarquable // Salles où l'état de la partie change, entre lesquelles le solveur cherche un parcours
+{
+    POINT_ENTREE, // La racine, point de départ et d'arrivée d'une chute
+    POINT_CLE,    // 'K'
+    POINT_CHUTE,  // 'U'
+    POINT_OUBLI,  // 'R'
+    POINT_SORTIE, // 'S'
+    NB_POINTS
+} PointRemarquable;
+
+#define ETAT_CLE 1   // Le joueur a la clé
+#define ETAT_CHUTE 2 // La salle U n'est pas visitée : y entrer ramène à l'entrée
+#define ETAT_OUBLI 4 // La salle R n'est pas visitée : y entrer fait oublier les visites
+#define NB_ETATS 8
+
+typedef struct Trajet // Chemin dans l'arbre d'un point remarquable à un autre
+{
+    int longueur;     // Nombre de mouvements, -1 si l'un des deux points n'existe pas
+    int traverses;    // Points traversés (bit 1 << PointRemarquable), sans le départ ni l'arrivée
+    bool porteFermee; // Vrai si le chemin descend depuis la porte 'D', ce qui demande la clé
+} Trajet;
+
+typedef struct Solution // Plus court parcours de l'entrée jusqu'à la sortie
+{
+    bool existe;         // Faux si aucun parcours n'atteint la sortie
+    const char *raison;  // Pourquoi il n'y a pas de solution
+    int nbMouvements;    // Nombre de mouvements du parcours
+    Touche *mouvements;  // Les mouvements (TOUCHE_HAUT, TOUCHE_GAUCHE, TOUCHE_DROITE)
+} Solution;
+
+#define CAPACITE_VISITES_MIN 64 // Nombre de cases de la table creuse des visites à sa création
+
+typedef struct Visites // Salles visitées par un joueur ; la table creuse devient un bitset quand elle serait plus grande
+{
+    uint32_t taille;   // Nombre de nœuds de l'arbre
+    uint32_t nombre;   // Nombre de nœuds visités
+    uint32_t capacite; // Nombre de cases de la table (puissance de 2), 0 en mode bitset
+    int decalage;      // Décalage du hachage multiplicatif : 32 - log2(capacite)
+    uint32_t *cles;    // Table à adressage ouvert des nœuds visités (AUCUN_NOEUD pour une case vide), NULL en mode bitset
+    uint64_t *bits;    // Bitset des nœuds visités, NULL tant que la table creuse suffit
+} Visites;
+
+typedef struct Partie // Partie jouée sans affichage ; l'arbre compact n'est que lu, et peut être partagé entre threads
+{
+    const ArbreCompact *arbre;    // Forme et événements du labyrinthe
+    Visites visites;              // Nœuds visités dans cette partie
+    uint32_t current;             // Indice du nœud actuel du joueur
+    uint32_t arrivee;             // Salle atteinte par le dernier déplacement, avant une éventuelle chute
+    const struct EventType *type; // Type d'événement de la salle actuelle, pour ses règles de départ
+    uint32_t nbNonExplores;       // Nombre de nœuds non visités
+    bool cleTrouvee;              // pour l'event K et D
+    bool randomMove;              // pour l'event A
+    bool gagnee;                  // Vrai quand le joueur a atteint la sortie
+    uint32_t nbMouvements;        // Nombre de déplacements effectués
+    uint32_t nbChutes;            // Nombre de fois où la salle U a ramené le joueur à l'entrée
+    uint32_t nbOublis;            // Nombre de fois où la salle R a fait oublier les visites
+    Alea alea;                    // Générateur pseudo-aléatoire de la partie
+    Tampon *image;                // Tampon des messages des événements, NULL pour une partie sans affichage
+} Partie;
+
+typedef enum CodeJournal // Code d'un mouvement dans un journal, sur 2 bits
+{
+    JOURNAL_HAUT,     // Vers le parent
+    JOURNAL_GAUCHE,   // Vers le fils gauche
+    JOURNAL_DROITE,   // Vers le fils droit
+    JOURNAL_ALEATOIRE // Le mouvement suivant a été tiré au hasard (salle A) : son code est la direction obtenue
+} CodeJournal;
+
+typedef struct Journal // Journal d'une partie : seuls les déplacements sont ajoutés, 4 codes par octet
+{
+    uint64_t graine;        // Graine du générateur de la partie, pour les mouvements aléatoires de la salle A
+    uint8_t *codes;         // Codes des mouvements (CodeJournal), 2 bits chacun
+    uint64_t nbCodes;       // Nombre de codes écrits
+    uint64_t capacite;      // Nombre d'octets alloués
+    uint32_t nbMouvements;  // Nombre de déplacements (un mouvement aléatoire prend deux codes)
+    // État à la fin de la partie, vérifié par rejouerJournal
+    uint32_t profondeur;    // Profondeur de la salle où se trouve le joueur
+    uint32_t nbNonExplores; // Nombre de nœuds non visités
+    bool cleTrouvee;        // Le joueur a la clé
+    bool gagnee;            // Le joueur a atteint la sortie
+} Journal;
+
+#define MAGIE_JOURNAL "LJRN" // Premiers octets d'un fichier de journal
+#define VERSION_JOURNAL 1    // Version du format, à changer à chaque modification de EnteteJournal ou des codes
+
+typedef struct EnteteJournal // En-tête d'un fichier de journal (voir sauvegarderJournal), en petit-boutiste
+{
+    char magie[4];          // MAGIE_JOURNAL
+    uint32_t version;       // VERSION_JOURNAL
+    uint64_t graine;        // Graine de la partie
+    uint64_t nbCodes;       // Nombre de codes qui suivent l'en-tête, 4 par octet
+    uint32_t nbMouvements;  // Nombre de déplacements
+    uint32_t profondeur;    // État final (voir Journal)
+    uint32_t nbNonExplores; // État final
+    uint8_t cleTrouvee;     // État final
+    uint8_t gagnee;         // État final
+    uint8_t reserve[2];     // À zéro
+} EnteteJournal;
+
+typedef struct EtatSalle // Salle du joueur, telle que la voient les règles d'un événement
+{
+    bool dejaVisitee; // La salle a déjà été visitée
+    bool cleTrouvee;  // Le joueur a la clé
+    Tampon *image;    // Tampon où écrire les messages, NULL pour une partie sans affichage
+} EtatSalle;
+
+// Actions demandées par les règles d'un événement, appliquées par chaque boucle de jeu à sa propre représentation
+#define ACTION_OUBLIER 1     // Oublier toutes les visites
+#define ACTION_CHUTE 2       // Retour à l'entrée, dont les événements s'appliquent à leur tour
+#define ACTION_CLE 4         // Le joueur trouve la clé
+#define ACTION_ALEATOIRE 8   // Le prochain mouvement sera aléatoire
+#define ACTION_BROUILLARD 16 // La salle n'est pas marquée comme visitée
+#define ACTION_SORTIE 32     // Le joueur a trouvé la sortie : la partie est gagnée
+
 typedef struct EventType // Structure d'un type d'événement
 {
     char letter;             // Les lettres des événements
     const char *description; // Description de l'événement
+    int minOccurrences;      // Nombre minimum d'occurrences de l'événement, si l'arbre a assez de nœuds
     int maxOccurrences;      // Nombre maximum d'occurrences de l'événement
+    int poids;               // Poids relatif dans le tirage des événements, 0 pour ceux placés à part
+    // Règles de l'événement, NULL si l'événement n'en a pas : les salles ordinaires ne coûtent aucun appel
+    int (*entrer)(const EtatSalle *salle);   // À l'entrée dans la salle, renvoie les actions (ACTION_*)
+    int (*quitter)(const EtatSalle *salle);  // Au départ de la salle, renvoie les actions (ACTION_*)
+    bool (*bloquer)(const EtatSalle *salle); // Vrai si la salle empêche de descendre vers ses enfants
 } EventType;
 
+// Règles des événements, définies dans toolBox.c
+static int entrerSortie(const EtatSalle *salle);
+static int entrerChute(const EtatSalle *salle);
+static int entrerAleatoire(const EtatSalle *salle);
+static int entrerOubli(const EtatSalle *salle);
+static int entrerBrouillard(const EtatSalle *salle);
+static int entrerPorte(const EtatSalle *salle);
+static int entrerCle(const EtatSalle *salle);
+static bool bloquerPorte(const EtatSalle *salle);
+
 // Tableau des événements possibles
+// L'entrée, la sortie, la clé et la porte ont un poids nul : leur place dépend de la forme de l'arbre
 static const EventType eventTypes[] = {
-    {'E', "Entree", 1},
-    {'S', "Sortie", 1},
-    {'U', "Tu tombes de l'arbre ! Retour au debut", 1},
-    {'A', "Ton prochain mouvement sera aleatoire", 1},
-    {'R', "Tu as perdu la memoire, tu ne sais plus ou tu es", 1},
-    {'B', "Il y a beaucoup de brouillard ici ...", 1},
-    {'D', "Une porte fermee bloque le passage. Trouve la cle", 1},
-    {'K', "Tu as trouve une cle", 1},
-    {'X', "Noeud standard", -1}, // -1 indique qu'il n'y a pas de limite
+    {'E', "Entree", 1, 1, 0, NULL, NULL, NULL},
+    {'S', "Sortie", 1, 1, 0, entrerSortie, NULL, NULL},
+    {'U', "Tu tombes de l'arbre ! Retour au debut", 0, 1, 1, entrerChute, NULL, NULL},
+    {'A', "Ton prochain mouvement sera aleatoire", 0, 1, 1, entrerAleatoire, NULL, NULL},
+    {'R', "Tu as perdu la memoire, tu ne sais plus ou tu es", 0, 1, 1, entrerOubli, NULL, NULL},
+    {'B', "Il y a beaucoup de brouillard ici ...", 0, 1, 1, entrerBrouillard, NULL, NULL},
+    {'D', "Une porte fermee bloque le passage. Trouve la cle", 1, 1, 0, entrerPorte, NULL, bloquerPorte},
+    {'K', "Tu as trouve une cle", 1, 1, 0, entrerCle, NULL, NULL},
+    {'X', "Noeud standard", 0, -1, 1, NULL, NULL, NULL}, // -1 indique qu'il n'y a pas de limite
+};
+
+// Nombre de types d'événements
+#define NB_TYPES_EVENTS (sizeof(eventTypes) / sizeof(eventTypes[0]))
+
+// Indice dans eventTypes de chaque octet d'événement, pour trouver ses règles sans parcourir le tableau.
+// Un nouvel événement s'ajoute aux deux tableaux ; les octets inconnus renvoient à l'entrée 'E', sans effet.
+static const uint8_t indiceEvent[256] = {
+    ['E'] = 0, ['S'] = 1, ['U'] = 2, ['A'] = 3, ['R'] = 4, ['B'] = 5, ['D'] = 6, ['K'] = 7, ['X'] = 8,
 };
 
+typedef struct TirageEvents // Tirage pondéré des événements (méthode des alias de Walker), en respectant leurs quotas
+{
+    uint32_t nbColonnes;                // Nombre de types actuellement tirables
+    uint8_t types[NB_TYPES_EVENTS];     // Indice dans eventTypes du type de chaque colonne
+    uint64_t seuils[NB_TYPES_EVENTS];   // La colonne est gardée si un tirage sur 32 bits est inférieur au seuil
+    uint8_t alias[NB_TYPES_EVENTS];     // Colonne tirée sinon
+    int64_t restants[NB_TYPES_EVENTS];  // Occurrences encore possibles de chaque type, -1 sans limite
+    int64_t manquants[NB_TYPES_EVENTS]; // Occurrences encore nécessaires pour atteindre le minimum de chaque type
+    uint64_t totalManquants;            // Somme des occurrences manquantes
+    bool force;                         // Il reste juste assez de nœuds pour les minimums : seuls ces types sont tirés
+} TirageEvents;
+
+typedef enum Chrono // Temps relevés dans les statistiques
+{
+    CHRONO_GENERER_ARBRE,   // Forme de l'arbre : genererArbre, genererArbreCompact, genererArbreCompactParallele
+    CHRONO_GENERER_EVENTS,  // Événements : genererEventsCompact, genererEventsCompactParallele
+    CHRONO_GENERER_FICHIER, // Labyrinthe écrit au fil de sa génération (ecrireLabyrintheFichier)
+    CHRONO_ATTENTE,         // Tour de boucle de jeu : attente des touches
+    CHRONO_LOGIQUE,         // Tour de boucle de jeu : application des touches lues
+    CHRONO_AFFICHAGE,       // Tour de boucle de jeu : composition et écriture de l'image
+    NB_CHRONOS
+} Chrono;
+
+typedef struct Releves // Compteurs et temps des chemins chauds ; sans --stats, chaque relevé se réduit à un test
+{
+    bool actives;                            // Vrai si les relevés sont faits
+    uint64_t mesures[NB_CHRONOS];            // Nombre de mesures de chaque temps
+    double totalNs[NB_CHRONOS];              // Temps cumulé de chaque temps
+    double maxNs[NB_CHRONOS];                // Plus longue mesure de chaque temps
+    uint64_t tours;                          // Tours de boucle de jeu
+    uint64_t touches;                        // Touches lues par les boucles de jeu
+    uint64_t oublis;                         // Oublis de toutes les visites d'une partie (salle R)
+    uint64_t octetsEffaces;                  // Octets remis à zéro par effacerVisites
+    uint64_t nonExploresMaj;                 // Mises à jour du nombre de nœuds non explorés
+    uint64_t images;                         // Images écrites par l'affichage (labyrinthe_stats_frame)
+    uint64_t octetsEcrits;                   // Octets écrits sur le terminal par l'affichage
+    uint64_t octetsMax;                      // Plus grande image écrite, en octets
+    uint64_t declenchements[NB_TYPES_EVENTS];// Entrées dans une salle, par type d'événement (indice dans eventTypes)
+} Releves;
+
 #endif // TOOLBOX_H